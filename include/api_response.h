@@ -2,27 +2,55 @@
 #ifndef __API_RESPONSE_H__
 #define __API_RESPONSE_H__
 
+#include <type_traits>
 #include <Arduino.h>
 #include <ArduinoJson.h>
-#include <WiFi.h>
+#include "cma_codes.h"
+
+// 文本字段缓冲区大小（字节，含结尾 '\0'），每个汉字占 3 字节
+#define CMA_TEXT_SHORT 24 // 8 个汉字
+#define CMA_TEXT_LONG  64 // 21 个汉字
+
+// 风向（八方位）
+typedef enum : uint8_t {
+  WIND_DIR_N,
+  WIND_DIR_NE,
+  WIND_DIR_E,
+  WIND_DIR_SE,
+  WIND_DIR_S,
+  WIND_DIR_SW,
+  WIND_DIR_W,
+  WIND_DIR_NW,
+  WIND_DIR_UNKNOWN
+} wind_dir_t;
 
 // 中国气象台天气数据结构
+// 不含指针的定长结构，可直接 memcpy 到 RTC 内存或 NVS，并可逐字节比较
+// （解析前整体清零，文本超长时在 UTF-8 字符边界截断，其余字节补零）
 typedef struct {
-  float  precipitation;      // 降水量 mm
-  float  temperature;        // 温度 °C
-  int    humidity;           // 湿度 %
-  String windDirection;      // 风向文字
-  int    windDirectionDegree;// 风向角度
-  float  windSpeed;          // 风速 m/s
-  String windScale;          // 风力级别描述
-  int    code;               // 状态码
-  String message;            // 消息内容
-  String place;              // 地区
-  String weather1;           // 当日天气1
-  String weather2;           // 当日天气2
+  float      precipitation;          // 降水量 mm
+  float      temperature;            // 温度 °C
+  float      windSpeed;              // 风速 m/s
+  int32_t    code;                   // 状态码
+  int16_t    windDirectionDegree;    // 风向角度，-1 表示未知
+  uint8_t    humidity;               // 湿度 %
+  wind_dir_t windDir;                // 风向
+  uint8_t    windScaleLevel;         // 风力等级，WIND_SCALE_UNKNOWN 表示未知
+  cma_weather_code_t weather1Code;   // 当日天气1 的天气现象代码
+  cma_weather_code_t weather2Code;   // 当日天气2 的天气现象代码
+  char       windDirection[CMA_TEXT_SHORT]; // 风向文字
+  char       windScale[CMA_TEXT_SHORT];     // 风力级别描述
+  char       weather1[CMA_TEXT_SHORT];      // 当日天气1
+  char       weather2[CMA_TEXT_SHORT];      // 当日天气2
+  char       place[CMA_TEXT_LONG];          // 地区
+  char       message[CMA_TEXT_LONG];        // 消息内容
 } cma_weather_t;
 
-DeserializationError deserializeCMAWeather(WiFiClient &json,
-                                           cma_weather_t &r);
+static_assert(std::is_trivially_copyable<cma_weather_t>::value,
+              "cma_weather_t 必须可直接复制");
+
+DeserializationError deserializeCMAWeather(Stream &json,
+                                          cma_weather_t &r);
+size_t getJsonArenaPeak();
 
 #endif
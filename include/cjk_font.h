@@ -0,0 +1,26 @@
+/* 子集化中文点阵字体声明 */
+#ifndef __CJK_FONT_H__
+#define __CJK_FONT_H__
+
+#include <Arduino.h>
+
+// 一个字形，位图每行按字节对齐（与 Adafruit_GFX::drawBitmap() 的格式相同）
+typedef struct {
+  uint32_t bitmapOffset;     // 在 cjk_font_t::bitmap 中的偏移
+  uint8_t  width, height;    // 位图尺寸
+  uint8_t  xAdvance;         // 绘制后光标移动的距离
+  int8_t   xOffset, yOffset; // 位图左上角相对于基线起点的偏移
+} cjk_glyph_t;
+
+// 由 fonts/scripts/gen_cjk_font.py 生成，codepoints 升序排列，与 glyph 一一对应
+typedef struct {
+  const uint8_t     *bitmap;
+  const cjk_glyph_t *glyph;
+  const uint16_t    *codepoints;
+  uint16_t           count;
+  uint8_t            yAdvance;
+} cjk_font_t;
+
+const cjk_glyph_t *findCjkGlyph(const cjk_font_t *font, uint32_t cp);
+
+#endif
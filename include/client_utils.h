@@ -8,17 +8,19 @@
 #ifdef USE_HTTP
   #include <WiFiClient.h>
 #else
-  #include <WiFiClientSecure.h>
+  #include "tls_session.h"
 #endif
 
-wl_status_t startWiFi(int &wifiRSSI);
+void beginWiFi();
+wl_status_t waitForWiFi(int &wifiRSSI);
 void killWiFi();
 bool waitForSNTPSync(tm *timeInfo);
 bool printLocalTime(tm *timeInfo);
 #ifdef USE_HTTP
-  int getCMAweather(WiFiClient &client, cma_weather_t &r);
+  int getCMAweather(WiFiClient &client, cma_weather_t r[], int status[]);
 #else
-  int getCMAweather(WiFiClientSecure &client, cma_weather_t &r);
+  int getCMAweather(ResumableClientSecure &client, cma_weather_t r[],
+                    int status[]);
 #endif
 
 #endif
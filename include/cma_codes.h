@@ -0,0 +1,60 @@
+/* 中国气象台风向、风力与天气现象编码声明 */
+#ifndef __CMA_CODES_H__
+#define __CMA_CODES_H__
+
+#include <Arduino.h>
+
+// 天气现象代码（GB/T 22164，与中国气象局天气现象编码一致）
+typedef enum : uint8_t {
+  WX_SUNNY                   = 0,  // 晴
+  WX_CLOUDY                  = 1,  // 多云
+  WX_OVERCAST                = 2,  // 阴
+  WX_SHOWER                  = 3,  // 阵雨
+  WX_THUNDERSHOWER           = 4,  // 雷阵雨
+  WX_THUNDERSHOWER_HAIL      = 5,  // 雷阵雨伴有冰雹
+  WX_SLEET                   = 6,  // 雨夹雪
+  WX_LIGHT_RAIN              = 7,  // 小雨
+  WX_MODERATE_RAIN           = 8,  // 中雨
+  WX_HEAVY_RAIN              = 9,  // 大雨
+  WX_STORM                   = 10, // 暴雨
+  WX_HEAVY_STORM             = 11, // 大暴雨
+  WX_SEVERE_STORM            = 12, // 特大暴雨
+  WX_SNOW_FLURRY             = 13, // 阵雪
+  WX_LIGHT_SNOW              = 14, // 小雪
+  WX_MODERATE_SNOW           = 15, // 中雪
+  WX_HEAVY_SNOW              = 16, // 大雪
+  WX_SNOWSTORM               = 17, // 暴雪
+  WX_FOG                     = 18, // 雾
+  WX_ICE_RAIN                = 19, // 冻雨
+  WX_DUSTSTORM               = 20, // 沙尘暴
+  WX_LIGHT_TO_MODERATE_RAIN  = 21, // 小到中雨
+  WX_MODERATE_TO_HEAVY_RAIN  = 22, // 中到大雨
+  WX_HEAVY_RAIN_TO_STORM     = 23, // 大到暴雨
+  WX_STORM_TO_HEAVY_STORM    = 24, // 暴雨到大暴雨
+  WX_HEAVY_TO_SEVERE_STORM   = 25, // 大暴雨到特大暴雨
+  WX_LIGHT_TO_MODERATE_SNOW  = 26, // 小到中雪
+  WX_MODERATE_TO_HEAVY_SNOW  = 27, // 中到大雪
+  WX_HEAVY_SNOW_TO_SNOWSTORM = 28, // 大到暴雪
+  WX_DUST                    = 29, // 浮尘
+  WX_SAND                    = 30, // 扬沙
+  WX_SANDSTORM               = 31, // 强沙尘暴
+  WX_DENSE_FOG               = 32, // 浓雾
+  WX_STRONG_DENSE_FOG        = 49, // 强浓雾
+  WX_HAZE                    = 53, // 霾
+  WX_MODERATE_HAZE           = 54, // 中度霾
+  WX_SEVERE_HAZE             = 55, // 重度霾
+  WX_EXTREME_HAZE            = 56, // 严重霾
+  WX_HEAVY_FOG               = 57, // 大雾
+  WX_EXTRA_HEAVY_FOG         = 58, // 特强浓雾
+  WX_UNKNOWN                 = 0xFF
+} cma_weather_code_t;
+
+// 风力等级未知
+#define WIND_SCALE_UNKNOWN 0xFF
+
+uint32_t utf8Next(const char *&p);
+cma_weather_code_t lookupWeatherCode(const char *text);
+int16_t parseWindDegree(const char *text);
+uint8_t parseWindScale(const char *text);
+
+#endif
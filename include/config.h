@@ -125,10 +125,12 @@
 //   使用证书校验需要在证书到期后更新 cert.h 并重新烧录。
 //   运行 cert.py 可生成新的 cert.h。
 //   目前 api.openweathermap.org 证书有效期至 2030-12-31 23:59:59。
-// （仅取消注释一个）
+// （仅取消注释一个；也可由构建参数指定，如主机测试环境的 -DUSE_HTTP）
+#if !defined(USE_HTTP) && !defined(USE_HTTPS_NO_CERT_VERIF)
 // #define USE_HTTP
 // #define USE_HTTPS_NO_CERT_VERIF
 #define USE_HTTPS_WITH_CERT_VERIF
+#endif
 
 // 风向指示方式
 // 可选择箭头、数字或罗盘方位表示，可同时与数字或方位组合。
@@ -188,6 +190,20 @@
 //   屏幕布局以 GNU FreeSans 字体为基础，替换其他字体可能导致间距异常。
 #define FONT_HEADER "fonts/FreeSans.h"
 
+// 中文字体（可选，默认关闭）
+// FONT_HEADER 中的字体只含 U+0020..U+00FF，中文标签与 API 返回的天气、风向文字
+// 需要另外的中文点阵字体。仓库中不附带生成好的中文字体，构建过程也不会自动生成：
+// 未定义 CJK_FONT_HEADER 时，所有中文字符都会被跳过，屏幕上只显示其余字符。
+//
+// 启用方法：完整的中文字体放不进 flash，请先用 fonts/scripts/gen_cjk_font.py
+// 生成只含固件所用字符的子集（区域设置、中国气象台天气与风力词汇以及 config.cpp
+// 中的地点名称，4 种字号共约数十 KB），例如：
+//   pip install freetype-py
+//   python fonts/scripts/gen_cjk_font.py --font NotoSansSC-Regular.otf
+// 然后取消下面一行的注释。
+// 注意：修改区域设置、地点名称或界面文字后需要重新生成。
+// #define CJK_FONT_HEADER "fonts/CJK/NotoSansSC_Regular.h"
+
 // 每日降水显示
 // Hi|Lo 下方的降水量可以按以下选项配置：
 //   0 : 禁用（始终隐藏）
@@ -216,6 +232,30 @@
 //   如需禁用电池监测，将该宏设为 0。
 #define BATTERY_MONITORING 1
 
+// 自适应刷新间隔（需要 BATTERY_MONITORING）
+//   0 : 按 config.cpp 中的 SLEEP_DURATION 固定间隔刷新（默认）
+//   1 : 由能耗模型根据电池电量、实测唤醒时长与续航目标 TARGET_RUNTIME 自动选择间隔，
+//       耗电快于计划时延长，天气变化剧烈时缩短。参数见 config.cpp，算法见
+//       src/energy_model.cpp。
+//   可由构建参数 -DADAPTIVE_SLEEP=1 覆盖（主机测试环境 native_adaptive 使用）。
+#ifndef ADAPTIVE_SLEEP
+#define ADAPTIVE_SLEEP 0
+#endif
+
+// 局部刷新（仅 DISP_BW_V2）
+//   0 : 每次全屏刷新（默认）
+//   1 : 只局部刷新内容变化的区域（天气、城市日期、状态栏），每 PARTIAL_REFRESH_FULL_EVERY
+//       次局部刷新后全屏刷新一次以消除残影。深度睡眠期间面板控制器保持供电（PIN_EPD_PWR 与
+//       PIN_EPD_RST 电平保持），以保留上一帧画面作为局部刷新的基准，睡眠电流会略有增加。
+#define PARTIAL_REFRESH 0
+
+// 唤醒源
+//   0 : ESP32 内部 RTC 定时器（默认）
+//   1 : 外部 RTC（PCF8563/BL8025C）闹钟。INT 引脚接 PIN_RTC_INT，并需外接上拉电阻。
+//       唤醒时间由晶振计时，精确对齐到分钟；睡眠期间关闭 RTC 外设电源域以降低电流。
+//       内部定时器仍作为后备，以防闹钟未触发。
+#define WAKE_FROM_EXT_RTC 0
+
 // NON-VOLATILE STORAGE (NVS) NAMESPACE
 #define NVS_NAMESPACE "weather_epd"
 
@@ -226,6 +266,21 @@
 //   level 2: 打印 API 返回数据
 #define DEBUG_LEVEL 0
 
+// 唤醒周期分段计时
+//   记录每次唤醒各阶段（WiFi、SNTP、HTTP、渲染、刷新等）的耗时，保存在 RTC 内存
+//   的环形缓冲区中，每 32 次唤醒以紧凑二进制格式通过串口导出一次。
+//   格式说明见 src/wake_profiler.cpp。设置为 0 以禁用。
+#define WAKE_PROFILER 1
+
+// 天气地点，在 "config.cpp" 的 CMA_LOCATIONS 中设置（1 ~ CMA_MAX_LOCATIONS 个）
+#define CMA_MAX_LOCATIONS 4
+typedef struct {
+  const char *province; // 省
+  const char *city;     // 市
+  const char *place;    // 区/县
+  const char *label;    // 卡片上显示的名称，为空时使用接口返回的地区名
+} cma_location_t;
+
 // 以下常量在 "config.cpp" 中定义
 extern const uint8_t PIN_BAT_ADC;
 extern const uint8_t PIN_EPD_BUSY;
@@ -240,16 +295,23 @@ extern const uint8_t PIN_I2C_SDA;
 extern const uint8_t PIN_I2C_SCL;
 extern const uint8_t SHT30_ADDRESS;
 extern const uint8_t RTC_ADDRESS;
+extern const uint8_t PIN_RTC_INT;
 extern const char *WIFI_SSID;
 extern const char *WIFI_PASSWORD;
 extern const unsigned long WIFI_TIMEOUT;
+extern const unsigned long WIFI_FAST_CONNECT_TIMEOUT;
+extern const unsigned WIFI_FAST_CONNECT_MAX_REUSE;
 extern const unsigned HTTP_CLIENT_TCP_TIMEOUT;
+extern const unsigned long HTTP_REQUEST_DEADLINE;
+extern const unsigned long HTTP_RETRY_BACKOFF;
+extern const unsigned long TLS_SESSION_MAX_AGE;
+extern const unsigned long DNS_CACHE_TTL;
 extern const String CMA_PID;
 extern const String CMA_KEY;
-extern const String CMA_PROVINCE;
-extern const String CMA_CITY;
-extern const String CMA_PLACE;
+extern const cma_location_t CMA_LOCATIONS[];
+extern const size_t CMA_LOCATION_COUNT;
 extern const String CMA_ENDPOINT;
+extern const uint16_t CMA_PORT;
 extern const String LAT;
 extern const String LON;
 extern const String CITY_STRING;
@@ -261,9 +323,19 @@ extern const char *REFRESH_TIME_FORMAT;
 extern const char *NTP_SERVER_1;
 extern const char *NTP_SERVER_2;
 extern const unsigned long NTP_TIMEOUT;
+extern const unsigned EXT_RTC_MAX_ERROR;
+extern const unsigned NTP_RESYNC_INTERVAL;
 extern const int SLEEP_DURATION;
 extern const int BED_TIME;
 extern const int WAKE_TIME;
+extern const uint32_t BATTERY_CAPACITY;
+extern const unsigned TARGET_RUNTIME;
+extern const float AWAKE_CURRENT;
+extern const float SLEEP_CURRENT;
+extern const int ADAPTIVE_SLEEP_MIN;
+extern const int ADAPTIVE_SLEEP_MAX;
+extern const unsigned FORCE_REFRESH_INTERVAL;
+extern const unsigned PARTIAL_REFRESH_FULL_EVERY;
 extern const int HOURLY_GRAPH_MAX;
 extern const uint32_t WARN_BATTERY_VOLTAGE;
 extern const uint32_t LOW_BATTERY_VOLTAGE;
@@ -360,5 +432,23 @@ extern const uint32_t MIN_BATTERY_VOLTAGE;
 #if !(defined(DEBUG_LEVEL))
   #error Invalid configuration. DEBUG_LEVEL not defined.
 #endif
+#if !(defined(ADAPTIVE_SLEEP))
+  #error Invalid configuration. ADAPTIVE_SLEEP not defined.
+#endif
+#if ADAPTIVE_SLEEP && !BATTERY_MONITORING
+  #error Invalid configuration. ADAPTIVE_SLEEP requires BATTERY_MONITORING.
+#endif
+#if !(defined(PARTIAL_REFRESH))
+  #error Invalid configuration. PARTIAL_REFRESH not defined.
+#endif
+#if PARTIAL_REFRESH && !defined(DISP_BW_V2)
+  #error Invalid configuration. PARTIAL_REFRESH requires DISP_BW_V2.
+#endif
+#if !(defined(WAKE_FROM_EXT_RTC))
+  #error Invalid configuration. WAKE_FROM_EXT_RTC not defined.
+#endif
+#if !(defined(WAKE_PROFILER))
+  #error Invalid configuration. WAKE_PROFILER not defined.
+#endif
 
 #endif
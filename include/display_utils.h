@@ -5,16 +5,20 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <time.h>
+#include "cma_codes.h"
 
 uint32_t readBatteryVoltage();
 uint32_t calcBatPercent(uint32_t v, uint32_t minv, uint32_t maxv);
 const uint8_t *getBatBitmap24(uint32_t batPercent);
+const uint8_t *getWeatherBitmap48(cma_weather_code_t code);
+const uint8_t *getWeatherBitmap96(cma_weather_code_t code);
 void getDateStr(String &s, tm *timeInfo);
 void getRefreshTimeStr(String &s, bool timeSuccess, tm *timeInfo);
 const char *getWiFidesc(int rssi);
 const uint8_t *getWiFiBitmap16(int rssi);
 const char *getHttpResponsePhrase(int code);
 const char *getWifiStatusPhrase(wl_status_t status);
+uint32_t fnv1a32(const void *data, size_t len, uint32_t hash=2166136261u);
 void printHeapUsage();
 void disableBuiltinLED();
 
@@ -0,0 +1,10 @@
+/* 跨深度睡眠的 DNS 解析缓存声明 */
+#ifndef __DNS_CACHE_H__
+#define __DNS_CACHE_H__
+
+#include <Arduino.h>
+
+bool resolveHost(const char *host, IPAddress &ip);
+void invalidateHost(const char *host);
+
+#endif
@@ -0,0 +1,13 @@
+/* 能耗模型声明：按电池续航目标自动选择刷新间隔 */
+#ifndef __ENERGY_MODEL_H__
+#define __ENERGY_MODEL_H__
+
+#include <Arduino.h>
+#include "api_response.h"
+
+void observeBatteryVoltage(uint32_t batteryVoltage);
+void observeWeatherVolatility(const cma_weather_t &weather);
+int chooseSleepInterval(unsigned long awakeMs);
+int selectSleepStep(float interval);
+
+#endif
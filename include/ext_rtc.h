@@ -0,0 +1,18 @@
+/* 外部 RTC（PCF8563/BL8025C）授时与漂移跟踪声明 */
+#ifndef __EXT_RTC_H__
+#define __EXT_RTC_H__
+
+#include <Arduino.h>
+#include <pcf8563.h>
+#include <time.h>
+#include "wake_pipeline.h"
+
+bool readExtRtcIntegrity();
+time_t extRtcDateToEpoch(const RTC_Date &date);
+bool syncTimeFromExtRtc(const peripheral_data_t &periph);
+void setTimeFromExtRtc(const peripheral_data_t &periph);
+void disciplineExtRtc(PCF8563_Class &rtc, const peripheral_data_t &periph);
+bool scheduleExtRtcAlarm(time_t wakeEpoch);
+void clearExtRtcAlarm();
+
+#endif
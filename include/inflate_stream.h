@@ -0,0 +1,49 @@
+/* gzip/deflate 响应解压流声明 */
+#ifndef __INFLATE_STREAM_H__
+#define __INFLATE_STREAM_H__
+
+#include <Arduino.h>
+
+typedef enum {
+  CONTENT_IDENTITY, // 未压缩
+  CONTENT_GZIP,     // gzip（RFC 1952）
+  CONTENT_DEFLATE,  // deflate（zlib 封装，或部分服务器发送的原始 deflate）
+  CONTENT_UNSUPPORTED
+} content_encoding_t;
+
+content_encoding_t parseContentEncoding(const String &header);
+
+/* 将压缩的响应体边读边解压，供 JSON 解析器读取
+ *
+ * 使用固定大小的静态缓冲区（含 32KB 字典），同一时刻只能存在一个实例。
+ */
+class InflateStream : public Stream
+{
+public:
+  InflateStream(Stream &src, content_encoding_t encoding);
+  bool begin();
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  bool fill();
+  bool pump();
+  size_t readSome(uint8_t *buf, size_t size);
+  bool skipGzipHeader();
+  void finishGzip();
+
+  Stream &_src;
+  content_encoding_t _encoding;
+  uint32_t _flags = 0;
+  size_t _inPos = 0, _inLen = 0;
+  size_t _outPos = 0, _outLen = 0; // 未读数据在字典中的范围
+  size_t _compressed = 0;
+  uint32_t _total = 0;             // 解压输出的总字节数（gzip ISIZE 按 2^32 取模）
+  bool _done = false;
+  bool _failed = false;
+};
+
+#endif
@@ -0,0 +1,19 @@
+/* 按像素宽度断行（支持中日韩文字）声明 */
+#ifndef __LINE_BREAK_H__
+#define __LINE_BREAK_H__
+
+#include <Arduino.h>
+#include <gfxfont.h>
+
+// 一行文本：text[0, len)，下一行从 next 开始（已跳过行首空格）
+typedef struct {
+  size_t len;
+  const char *next;
+} text_line_t;
+
+text_line_t breakLine(const GFXfont *font, const char *text,
+                      uint16_t maxWidth);
+size_t fitWithEllipsis(const GFXfont *font, const char *text,
+                       uint16_t maxWidth, uint16_t ellipsisWidth);
+
+#endif
@@ -43,8 +43,11 @@
 
 typedef enum alignment { LEFT, RIGHT, CENTER } alignment_t;
 
+void setFont(const GFXfont *font);
 uint16_t getStringWidth(const String &text);
 uint16_t getStringHeight(const String &text);
+void drawString(int16_t x, int16_t y, const char *text, alignment_t alignment,
+                uint16_t color=GxEPD_BLACK);
 void drawString(int16_t x, int16_t y, const String &text, alignment_t alignment,
                 uint16_t color=GxEPD_BLACK);
 void drawMultiLnString(int16_t x, int16_t y, const String &text,
@@ -52,13 +55,32 @@ void drawMultiLnString(int16_t x, int16_t y, const String &text,
                        uint16_t max_lines, int16_t line_spacing,
                        uint16_t color=GxEPD_BLACK);
 void initDisplay();
+void beginDisplayList();
+void endDisplayList();
+void replayDisplayList(uint16_t page);
 void powerOffDisplay();
 void drawCurrentWeather(const cma_weather_t &weather,
                         float inTemp, float inHumidity);
+void drawLocationTiles(const cma_weather_t w[], const int status[],
+                       size_t count);
 void drawLocationDate(const String &city, const String &date);
 void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
                    int rssi, uint32_t batVoltage);
 void drawError(const uint8_t *bitmap_196x196,
                const String &errMsgLn1, const String &errMsgLn2="");
+uint32_t hashFrameContent(const cma_weather_t weather[], const int status[],
+                          size_t count,
+                          float inTemp, float inHumidity,
+                          const String &city, const String &date,
+                          const String &statusStr,
+                          int rssi, uint32_t batVoltage);
+bool skipFrameRefresh(uint32_t frameHash);
+void recordFrameRefresh(uint32_t frameHash);
+#if PARTIAL_REFRESH
+void refreshChangedRegions();
+#endif
+#if DEBUG_LEVEL >= 1
+void printRenderStats();
+#endif
 
 #endif
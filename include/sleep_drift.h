@@ -0,0 +1,12 @@
+/* 深度睡眠定时器漂移校准声明 */
+#ifndef __SLEEP_DRIFT_H__
+#define __SLEEP_DRIFT_H__
+
+#include <Arduino.h>
+
+float updateSleepRate(float rate, float observed);
+uint64_t sleepTimerFor(uint64_t sleepSeconds, float rate);
+void observeSleepDrift();
+uint64_t calibrateSleepDuration(uint64_t sleepSeconds);
+
+#endif
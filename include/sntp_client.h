@@ -0,0 +1,10 @@
+/* 单次交换的 SNTP 客户端声明 */
+#ifndef __SNTP_CLIENT_H__
+#define __SNTP_CLIENT_H__
+
+#include <Arduino.h>
+
+bool sntpSyncTime(const char *const servers[], size_t count,
+                  unsigned long timeoutMs);
+
+#endif
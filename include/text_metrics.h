@@ -0,0 +1,31 @@
+/* 文本尺寸测量与缓存声明 */
+#ifndef __TEXT_METRICS_H__
+#define __TEXT_METRICS_H__
+
+#include <Arduino.h>
+#include <gfxfont.h>
+#include "cjk_font.h"
+
+// 文本外接矩形，相对于基线起点 (0, 0)
+typedef struct {
+  int16_t  x1, y1;
+  uint16_t w, h;
+} text_bounds_t;
+
+// 一个字符的字形：GFX 字体中的字形 bitmap 为 NULL，中文字体中的字形 bitmap 指向
+// 其位图（每行按字节对齐）
+typedef struct {
+  const uint8_t *bitmap;
+  uint8_t  width, height;
+  uint8_t  xAdvance;
+  int8_t   xOffset, yOffset;
+} glyph_info_t;
+
+void registerCjkFont(const GFXfont *font, const cjk_font_t *cjk);
+uint32_t nextTextChar(const char *&p);
+bool lookupGlyph(const GFXfont *font, uint32_t cp, glyph_info_t &g);
+text_bounds_t measureText(const GFXfont *font, const char *text, size_t len);
+uint16_t measureAdvance(const GFXfont *font, const char *text, size_t len);
+void getTextMetricsStats(uint32_t &hits, uint32_t &misses);
+
+#endif
@@ -0,0 +1,26 @@
+/* 可跨深度睡眠恢复 TLS 会话的安全客户端声明 */
+#ifndef __TLS_SESSION_H__
+#define __TLS_SESSION_H__
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+/* 在握手前提供 RTC 内存中保存的 TLS 会话，服务器接受时只需简短握手
+ * （省去证书链传输与校验及密钥交换）。其余行为与 WiFiClientSecure 相同。
+ */
+class ResumableClientSecure : public WiFiClientSecure
+{
+public:
+  using WiFiClientSecure::connect;
+  int connect(IPAddress ip, uint16_t port, const char *host, int32_t timeout);
+  int connect(const char *host, uint16_t port);
+  int connect(const char *host, uint16_t port, int32_t timeout);
+  bool saveSession();
+
+private:
+  int startSslClient(IPAddress ip, uint16_t port, const char *host,
+                     int32_t timeout);
+  uint32_t _sessionKey = 0;
+};
+
+#endif
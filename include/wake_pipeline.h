@@ -0,0 +1,22 @@
+/* 唤醒流水线声明：WiFi 连接期间并行初始化外设 */
+#ifndef __WAKE_PIPELINE_H__
+#define __WAKE_PIPELINE_H__
+
+#include <Arduino.h>
+#include <pcf8563.h>
+
+// 外设任务采集到的数据
+typedef struct {
+  bool          sht30Found;   // 是否检测到 SHT30
+  float         inTemp;       // 室内温度 °C，失败时为 NAN
+  float         inHumidity;   // 室内湿度 %，失败时为 NAN
+  RTC_Date      rtcTime;      // 外部 RTC 时间（UTC）
+  bool          rtcIntegrity; // 外部 RTC 计时未曾中断
+  unsigned long rtcReadMs;    // 读取外部 RTC 时的 millis()
+} peripheral_data_t;
+
+void startPeripheralTask(PCF8563_Class &rtc);
+const peripheral_data_t &waitForPeripherals();
+void waitForDisplay();
+
+#endif
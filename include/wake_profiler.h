@@ -0,0 +1,30 @@
+/* 唤醒周期分阶段计时声明 */
+#ifndef __WAKE_PROFILER_H__
+#define __WAKE_PROFILER_H__
+
+#include <Arduino.h>
+
+// 一次唤醒中被计时的各个阶段
+// 注意：新增阶段只能追加在 PROF_PHASE_COUNT 之前，以保持导出格式兼容。
+typedef enum prof_phase {
+  PROF_BATTERY_ADC,      // 电池电压 ADC 采样
+  PROF_WIFI_CONNECT,     // startWiFi
+  PROF_SNTP_SYNC,        // waitForSNTPSync
+  PROF_HTTP_DNS,         // 解析 CMA_ENDPOINT（命中 DNS 缓存时接近 0）
+  PROF_HTTP_CONNECT,     // TCP 连接与 TLS 握手
+  PROF_HTTP_FIRST_BYTE,  // 发送请求直到收到响应头
+  PROF_HTTP_BODY_PARSE,  // 接收响应体并解析 JSON（流式解析，二者同时进行）
+  PROF_SHT30_READ,       // 读取 SHT30
+  PROF_DISPLAY_INIT,     // initDisplay
+  PROF_RENDER,           // 各绘制函数（分页时为所有页之和）
+  PROF_EPD_REFRESH,      // nextPage：SPI 传输与等待 BUSY
+  PROF_EPD_POWER_OFF,    // powerOffDisplay
+  PROF_PHASE_COUNT
+} prof_phase_t;
+
+void profilerStart(prof_phase_t phase);
+void profilerStop(prof_phase_t phase);
+void profilerCommit(unsigned long awakeMs);
+void profilerDump(Print &out);
+
+#endif
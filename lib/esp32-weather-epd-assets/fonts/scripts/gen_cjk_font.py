@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""生成子集化的中文点阵字体头文件
+
+FONT_HEADER 中的 8 位 GFX 字体只含 U+0020..U+00FF。完整的中文字体有数万个字形，
+放不进 flash，这里只保留固件实际会显示的字符：
+
+  * 所选区域设置（include/locales/locale_<LOCALE>.inc）中被下列源文件引用的字符串
+  * DISPLAY_SOURCES 中的字符串与字符字面量：中国气象台天气现象词汇、
+    config.cpp 中的地点名称、渲染器的标签以及状态栏与错误界面的文字
+  * 中国气象台 API 返回的风向与风力词汇（见 WIND_VOCABULARY）
+  * --extra 指定的字符，如 API 返回、但未写在 config.cpp 中的地名
+
+码点升序存放（各字号共用），固件中按码点二分查找字形。位图每行按字节对齐，
+可直接交给 Adafruit_GFX::drawBitmap() 绘制。
+
+用法：
+  pip install freetype-py
+  python gen_cjk_font.py --font NotoSansSC-Regular.otf
+
+生成的头文件默认写入 fonts/CJK/<name>.h，然后在 config.h 中设置
+  #define CJK_FONT_HEADER "fonts/CJK/<name>.h"
+
+注意：源文件或区域设置中的中文有改动后，需要重新运行本脚本。
+"""
+import argparse
+import os
+import re
+import sys
+
+import freetype
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+FONTS_DIR = os.path.dirname(SCRIPT_DIR)
+REPO_DIR = os.path.abspath(os.path.join(FONTS_DIR, '..', '..', '..'))
+
+# 中国气象台 API 的风向（如"东北风"、"无持续风向"）与风力（如"<3级"、"微风"）词汇
+WIND_VOCABULARY = '东南西北偏风无持续向静微级小于＜到转'
+
+# 其中的文字可能显示在屏幕上的源文件（相对于 src/），只输出到串口的模块不必扫描
+DISPLAY_SOURCES = [
+    '_strftime.cpp',
+    'cma_codes.cpp',
+    'config.cpp',
+    'display_utils.cpp',
+    'main.cpp',
+    'renderer.cpp',
+]
+
+# 与 Adafruit fontconvert 相同，使生成的字号与 FONT_HEADER 中同名字号的字体匹配
+DEFAULT_DPI = 141
+DEFAULT_SIZES = '6,12,16,26'
+
+# C/C++ 的注释、字符串与字符字面量，其余代码按 ';' 切分
+TOKEN_RE = re.compile(r'//[^\n]*|/\*.*?\*/'
+                      r'|"(?:\\.|[^"\\\n])*"|\'(?:\\.|[^\'\\\n])*\''
+                      r'|;|[^;"\'/]+|/', re.S)
+IDENT_RE = re.compile(r'\b[A-Za-z_]\w*\b')
+
+
+def tokenize(path):
+    with open(path, encoding='utf-8') as f:
+        return [m.group(0) for m in TOKEN_RE.finditer(f.read())]
+
+
+def is_literal(token):
+    return token[0] in '"\''
+
+
+def literal_chars(token):
+    """字面量中 FONT_HEADER 字体无法显示的字符（> U+00FF）"""
+    return {ord(c) for c in token if ord(c) > 0xFF}
+
+
+def read_locale(config_h):
+    with open(config_h, encoding='utf-8') as f:
+        m = re.search(r'^\s*#define\s+LOCALE\s+(\w+)', f.read(), re.M)
+    if m is None:
+        sys.exit('无法从 %s 读取 LOCALE' % config_h)
+    return m.group(1)
+
+
+def locale_definitions(path):
+    """区域设置文件中每个变量名 → 其初始化器中的字面量"""
+    defs = {}
+    statement = []
+    for token in tokenize(path):
+        if token.startswith('//') or token.startswith('/*'):
+            continue
+        if token != ';':
+            statement.append(token)
+            continue
+        code = ''.join(t for t in statement if not is_literal(t))
+        m = re.search(r'(\w+)\s*(?:\[[^\]]*\])?\s*=', code)
+        if m:
+            defs[m.group(1)] = [t for t in statement if is_literal(t)]
+        statement = []
+    return defs
+
+
+def collect_codepoints(locale, extra):
+    used_idents = set()
+    codepoints = set()
+    for source in DISPLAY_SOURCES:
+        for token in tokenize(os.path.join(REPO_DIR, 'src', source)):
+            if is_literal(token):
+                codepoints |= literal_chars(token)
+            elif not token.startswith('/'):
+                used_idents.update(IDENT_RE.findall(token))
+
+    locale_path = os.path.join(REPO_DIR, 'include', 'locales',
+                               'locale_%s.inc' % locale)
+    used = 0
+    for name, literals in locale_definitions(locale_path).items():
+        if name in used_idents:
+            used += 1
+            for token in literals:
+                codepoints |= literal_chars(token)
+    print('区域设置 %s：引用了 %d 个字符串' % (locale, used), file=sys.stderr)
+
+    codepoints |= {ord(c) for c in WIND_VOCABULARY + extra if ord(c) > 0xFF}
+    return codepoints
+
+
+def render_size(face, size, dpi, codepoints):
+    """按字号栅格化，返回 (位图字节, 字形表, 行高)"""
+    face.set_char_size(size << 6, 0, dpi, 0)
+    bitmap = bytearray()
+    glyphs = []
+    for cp in codepoints:
+        face.load_char(cp, freetype.FT_LOAD_RENDER
+                       | freetype.FT_LOAD_TARGET_MONO)
+        g = face.glyph
+        bm = g.bitmap
+        row_bytes = (bm.width + 7) // 8
+        offset = len(bitmap)
+        for row in range(bm.rows):
+            start = row * bm.pitch
+            bitmap += bytes(bm.buffer[start:start + row_bytes])
+        if bm.width > 255 or bm.rows > 255:
+            sys.exit('U+%04X 在 %dpt 时过大' % (cp, size))
+        glyphs.append((offset, bm.width, bm.rows, g.advance.x >> 6,
+                       g.bitmap_left, 1 - g.bitmap_top))
+    y_advance = face.size.height >> 6
+    return bitmap, glyphs, y_advance
+
+
+def c_array(values, fmt, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('  ' + ', '.join(fmt % v for v in values[i:i + per_line]))
+    return ',\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='生成子集化的中文点阵字体头文件')
+    parser.add_argument('--font', required=True,
+                        help='TrueType/OpenType 字体文件，如 NotoSansSC-Regular.otf')
+    parser.add_argument('--face-index', type=int, default=0,
+                        help='.ttc 字体集合中的字体序号')
+    parser.add_argument('--name',
+                        help='C 标识符前缀，默认取字体文件名')
+    parser.add_argument('--sizes', default=DEFAULT_SIZES,
+                        help='字号（pt），逗号分隔，默认 %s' % DEFAULT_SIZES)
+    parser.add_argument('--dpi', type=int, default=DEFAULT_DPI)
+    parser.add_argument('--locale',
+                        help='区域设置，默认读取 include/config.h 中的 LOCALE')
+    parser.add_argument('--extra', default='',
+                        help='额外包含的字符')
+    parser.add_argument('--output',
+                        help='输出文件，默认为 fonts/CJK/<name>.h')
+    args = parser.parse_args()
+
+    name = args.name or re.sub(r'\W', '_',
+                               os.path.splitext(os.path.basename(args.font))[0])
+    sizes = [int(s) for s in args.sizes.split(',')]
+    locale = args.locale or read_locale(
+        os.path.join(REPO_DIR, 'include', 'config.h'))
+    output = args.output or os.path.join(FONTS_DIR, 'CJK', name + '.h')
+
+    codepoints = sorted(collect_codepoints(locale, args.extra))
+    outside_bmp = [cp for cp in codepoints if cp > 0xFFFF]
+    if outside_bmp:
+        print('忽略 BMP 以外的字符：%s'
+              % ' '.join('U+%X' % cp for cp in outside_bmp), file=sys.stderr)
+        codepoints = [cp for cp in codepoints if cp <= 0xFFFF]
+
+    face = freetype.Face(args.font, args.face_index)
+    missing = {cp for cp in codepoints if face.get_char_index(cp) == 0}
+    if missing:
+        print('字体中没有以下字符，已跳过：%s'
+              % ''.join(chr(cp) for cp in sorted(missing)), file=sys.stderr)
+        codepoints = [cp for cp in codepoints if cp not in missing]
+    if not codepoints:
+        sys.exit('没有需要生成的字符')
+
+    guard = '__FONTS_CJK_%s_H__' % name.upper()
+    out = []
+    out.append('// 由 fonts/scripts/gen_cjk_font.py 生成，请勿手动修改')
+    out.append('// 字体：%s  区域设置：%s  字符数：%d'
+               % (os.path.basename(args.font), locale, len(codepoints)))
+    out.append('#ifndef %s' % guard)
+    out.append('#define %s' % guard)
+    out.append('')
+    out.append('#include "cjk_font.h"')
+    out.append('')
+    out.append('// 升序排列，各字号共用')
+    out.append('const uint16_t %s_codepoints[] PROGMEM = {' % name)
+    out.append(c_array(codepoints, '0x%04X', 12))
+    out.append('};')
+    total = 2 * len(codepoints)
+
+    for size in sizes:
+        font = '%s_%dpt' % (name, size)
+        bitmap, glyphs, y_advance = render_size(face, size, args.dpi,
+                                                codepoints)
+        out.append('')
+        out.append('const uint8_t %sBitmaps[] PROGMEM = {' % font)
+        out.append(c_array(list(bitmap), '0x%02X', 16))
+        out.append('};')
+        out.append('')
+        out.append('const cjk_glyph_t %sGlyphs[] PROGMEM = {' % font)
+        for i, (cp, g) in enumerate(zip(codepoints, glyphs)):
+            end = ' };' if i == len(glyphs) - 1 else ','
+            out.append('  { %6d, %3d, %3d, %3d, %4d, %4d }%s   // 0x%04X \'%s\''
+                       % (g + (end, cp, chr(cp))))
+        out.append('')
+        out.append('const cjk_font_t %s PROGMEM = {' % font)
+        out.append('  %sBitmaps,' % font)
+        out.append('  %sGlyphs,' % font)
+        out.append('  %s_codepoints, %d, %d };' % (name, len(codepoints),
+                                                   y_advance))
+        out.append('')
+        out.append('#define CJK_FONT_%dpt %s' % (size, font))
+        size_bytes = len(bitmap) + 12 * len(glyphs)
+        total += size_bytes
+        print('%dpt：%d 字节' % (size, size_bytes), file=sys.stderr)
+
+    out.append('')
+    out.append('#endif')
+    out.append('')
+    out.append('// 约 %d 字节' % total)
+    out.append('')
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out))
+    print('%s：%d 个字符，约 %d 字节' % (output, len(codepoints), total),
+          file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
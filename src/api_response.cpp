@@ -1,27 +1,208 @@
-/* 中国气象台 API 解析 */
+/* 中国气象台 API 解析
+ *
+ * 解析使用过滤器，只保留 cma_weather_t 需要的字段，其余内容边读边丢弃。
+ * JsonDocument 的内存来自固定大小的静态区（JSON_ARENA_SIZE），不使用堆，
+ * 因此无论响应多大都不会在 TLS 会话期间耗尽或碎片化堆内存；
+ * 超出上限时返回 DeserializationError::NoMemory。
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <ArduinoJson.h>
 #include "api_response.h"
+#include "cma_codes.h"
 #include "config.h"
 
-// 若 API 未提供风向角度，则根据中文风向转换
-static int cnWindToDeg(const String &s)
+// 过滤后文档的内存上限，含解析过程中的临时字符串
+static const size_t JSON_ARENA_SIZE = 4096;
+
+/* 在静态区上顺序分配的分配器
+ *
+ * 每次解析前重置。释放或重新分配最后一块时原地收缩/扩展；其他块缩小时原地保留
+ * （ArduinoJson 解析结束时会收缩字符串与内存池），释放只在重置时回收。
+ */
+class ArenaAllocator : public ArduinoJson::Allocator
 {
-  if (s.indexOf("北") != -1 && s.indexOf("东") == -1 && s.indexOf("西") == -1) return 0;
-  if (s.indexOf("东北") != -1) return 45;
-  if (s.indexOf("东") != -1 && s.indexOf("南") == -1) return 90;
-  if (s.indexOf("东南") != -1) return 135;
-  if (s.indexOf("南") != -1 && s.indexOf("东") == -1 && s.indexOf("西") == -1) return 180;
-  if (s.indexOf("西南") != -1) return 225;
-  if (s.indexOf("西") != -1 && s.indexOf("北") == -1) return 270;
-  if (s.indexOf("西北") != -1) return 315;
-  return 0;
+public:
+  void reset()
+  {
+    used_ = 0;
+    last_ = SIZE_MAX;
+    peak_ = 0;
+  }
+
+  size_t peak() const { return peak_; }
+
+  void *allocate(size_t size) override
+  {
+    size_t offset = align(used_) + HEADER;
+    if (offset + size > JSON_ARENA_SIZE)
+    {
+      return nullptr;
+    }
+    setSize(offset, size);
+    last_ = offset;
+    used_ = offset + size;
+    peak_ = std::max(peak_, used_);
+    return arena_ + offset;
+  }
+
+  void deallocate(void *ptr) override
+  {
+    if (ptr != nullptr && offsetOf(ptr) == last_)
+    {
+      used_ = last_ - HEADER;
+      last_ = SIZE_MAX;
+    }
+  }
+
+  void *reallocate(void *ptr, size_t newSize) override
+  {
+    if (ptr == nullptr)
+    {
+      return allocate(newSize);
+    }
+    size_t offset = offsetOf(ptr);
+    if (offset == last_)
+    { // 最后一块：原地调整
+      if (offset + newSize > JSON_ARENA_SIZE)
+      {
+        return nullptr;
+      }
+      setSize(offset, newSize);
+      used_ = offset + newSize;
+      peak_ = std::max(peak_, used_);
+      return ptr;
+    }
+    if (newSize <= sizeOf(offset))
+    { // 不是最后一块，缩小时不必搬移，多余的空间在重置时回收
+      return ptr;
+    }
+    void *p = allocate(newSize);
+    if (p != nullptr)
+    {
+      memcpy(p, ptr, std::min(sizeOf(offset), newSize));
+    }
+    return p;
+  }
+
+private:
+  // 每块前保存块大小（uint32_t），补齐到 8 字节，使返回的指针与静态区一样
+  // 8 字节对齐（内存池中有 double 与 64 位整数）
+  static const size_t HEADER = 8;
+
+  static size_t align(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+  size_t offsetOf(void *ptr) const
+  {
+    return static_cast<uint8_t *>(ptr) - arena_;
+  }
+
+  size_t sizeOf(size_t offset) const
+  {
+    uint32_t size;
+    memcpy(&size, arena_ + offset - HEADER, sizeof(size));
+    return size;
+  }
+
+  void setSize(size_t offset, size_t size)
+  {
+    uint32_t s = size;
+    memcpy(arena_ + offset - HEADER, &s, sizeof(s));
+  }
+
+  alignas(8) uint8_t arena_[JSON_ARENA_SIZE];
+  size_t used_ = 0;
+  size_t last_ = SIZE_MAX;
+  size_t peak_ = 0;
+};
+
+static ArenaAllocator jsonArena;
+
+/* 最近一次解析时静态区的使用峰值（字节） */
+size_t getJsonArenaPeak()
+{
+  return jsonArena.peak();
+}
+
+#if DEBUG_LEVEL >= 1
+/* 统计读取字节数的流包装，用于输出解析吞吐量 */
+class CountingStream : public Stream
+{
+public:
+  explicit CountingStream(Stream &s) : s_(s) {}
+  size_t count() const { return count_; }
+  int available() override { return s_.available(); }
+  int peek() override { return s_.peek(); }
+  int read() override
+  {
+    int c = s_.read();
+    if (c >= 0)
+    {
+      ++count_;
+    }
+    return c;
+  }
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  Stream &s_;
+  size_t count_ = 0;
+};
+#endif
+
+/* 复制 UTF-8 字符串，超长时在字符边界截断，剩余字节补零 */
+static void copyUtf8(char *dst, size_t size, const char *src)
+{
+  size_t len = strnlen(src, size);
+  if (len >= size)
+  { // 回退到不超过 size - 1 字节的最后一个字符起始处
+    len = size - 1;
+    while (len > 0 && (static_cast<uint8_t>(src[len]) & 0xC0) == 0x80)
+    {
+      --len;
+    }
+  }
+  memcpy(dst, src, len);
+  memset(dst + len, 0, size - len);
 }
 
-DeserializationError deserializeCMAWeather(WiFiClient &json,
-                                           cma_weather_t &r)
+#define COPY_TEXT(field, key) \
+  copyUtf8(r.field, sizeof(r.field), root[key] | "")
+
+DeserializationError deserializeCMAWeather(Stream &json,
+                                          cma_weather_t &r)
 {
-  JsonDocument doc;
-  DeserializationError error = deserializeJson(doc, json);
+  jsonArena.reset();
+  // 过滤器与文档都分配在静态区中
+  JsonDocument filter(&jsonArena);
+  filter["code"]                = true;
+  filter["msg"]                 = true;
+  filter["precipitation"]       = true;
+  filter["temperature"]         = true;
+  filter["humidity"]            = true;
+  filter["windDirection"]       = true;
+  filter["windDirectionDegree"] = true;
+  filter["windSpeed"]           = true;
+  filter["windScale"]           = true;
+  filter["place"]               = true;
+  filter["weather1"]            = true;
+  filter["weather2"]            = true;
+
+  JsonDocument doc(&jsonArena);
+#if DEBUG_LEVEL >= 1
+  CountingStream input(json);
+  unsigned long parseStart = millis();
+#else
+  Stream &input = json;
+#endif
+  DeserializationError error = deserializeJson(
+    doc, input, DeserializationOption::Filter(filter));
+#if DEBUG_LEVEL >= 1
+  unsigned long parseMs = millis() - parseStart;
+  Serial.printf("JSON 解析：%u字节，%lums，静态区峰值 %u/%u字节\n",
+                input.count(), parseMs, jsonArena.peak(), JSON_ARENA_SIZE);
+#endif
 #if DEBUG_LEVEL >= 2
   serializeJsonPretty(doc, Serial);
 #endif
@@ -30,19 +211,26 @@ DeserializationError deserializeCMAWeather(WiFiClient &json,
   }
 
   JsonObject root = doc.as<JsonObject>();
+  memset(&r, 0, sizeof(r));
   r.code = root["code"] | 0;
-  r.message = root["msg"] | String();
   r.precipitation = root["precipitation"] | 0.0f;
   r.temperature = root["temperature"] | 0.0f;
   r.humidity = root["humidity"] | 0;
-  r.windDirection = root["windDirection"] | String();
-  r.windDirectionDegree = root["windDirectionDegree"]
-                           | cnWindToDeg(r.windDirection);
   r.windSpeed = root["windSpeed"] | 0.0f;
-  r.windScale = root["windScale"] | String();
-  r.place = root["place"] | String();
-  r.weather1 = root["weather1"] | String();
-  r.weather2 = root["weather2"] | String();
+  COPY_TEXT(message, "msg");
+  COPY_TEXT(windDirection, "windDirection");
+  COPY_TEXT(windScale, "windScale");
+  COPY_TEXT(place, "place");
+  COPY_TEXT(weather1, "weather1");
+  COPY_TEXT(weather2, "weather2");
+  // 文字一次性转换为数字代码，渲染时无需再做字符串处理
+  // 若 API 未提供风向角度，则根据中文风向计算
+  r.windDirectionDegree = root["windDirectionDegree"]
+                           | parseWindDegree(r.windDirection);
+  r.windDir = r.windDirectionDegree < 0 ? WIND_DIR_UNKNOWN
+            : static_cast<wind_dir_t>((r.windDirectionDegree + 22) % 360 / 45);
+  r.windScaleLevel = parseWindScale(r.windScale);
+  r.weather1Code = lookupWeatherCode(r.weather1);
+  r.weather2Code = lookupWeatherCode(r.weather2);
   return error;
 } // end deserializeCMAWeather
-
@@ -0,0 +1,27 @@
+/* 子集化中文点阵字体
+ *
+ * 完整的中文字体有数万个字形，这里的字体只包含固件会显示的字符（由
+ * gen_cjk_font.py 根据区域设置与源文件中的文字生成），码点表升序存放，
+ * 查找时二分查找，码点表本身每字只占 2 字节。
+ */
+#include <algorithm>
+#include <Arduino.h>
+
+#include "cjk_font.h"
+
+/* 取得码点对应的字形，字体中没有该字符时返回NULL */
+const cjk_glyph_t *findCjkGlyph(const cjk_font_t *font, uint32_t cp)
+{
+  if (font == NULL || cp > UINT16_MAX)
+  {
+    return NULL;
+  }
+  const uint16_t *end = font->codepoints + font->count;
+  const uint16_t *it = std::lower_bound(font->codepoints, end,
+                                        static_cast<uint16_t>(cp));
+  if (it == end || *it != cp)
+  {
+    return NULL;
+  }
+  return &font->glyph[it - font->codepoints];
+} // end findCjkGlyph
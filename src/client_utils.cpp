@@ -16,12 +16,15 @@
  */
 
 // built-in C++ libraries
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
 // arduino/esp32 libraries
 #include <Arduino.h>
-#include <esp_sntp.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
 #include <HTTPClient.h>
 #include <SPI.h>
 #include <time.h>
@@ -37,50 +40,170 @@
 #include "client_utils.h"
 #include "config.h"
 #include "display_utils.h"
+#include "dns_cache.h"
+#include "inflate_stream.h"
+#include "sntp_client.h"
+#include "wake_profiler.h"
 #ifndef USE_HTTP
-  #include <WiFiClientSecure.h>
+  #include "tls_session.h"
+#endif
+
+// 单次尝试至少需要的时间，剩余时间不足时不再重试
+static const unsigned long HTTP_MIN_ATTEMPT_TIME = 2000; // 毫秒
+
+#if DEBUG_LEVEL >= 1
+// 本次唤醒中请求复用已有连接与重新连接的次数
+static unsigned connReused    = 0;
+static unsigned connReconnect = 0;
 #endif
 
 #ifdef USE_HTTP
-  static const uint16_t CMA_PORT = 80;
+  static const uint16_t CMA_DEFAULT_PORT = 80;
+  typedef WiFiClient cma_client_t;
 #else
-  static const uint16_t CMA_PORT = 443;
+  static const uint16_t CMA_DEFAULT_PORT = 443;
+  typedef ResumableClientSecure cma_client_t;
 #endif
 
-/* 启动并连接WiFi
- * 接收一个int参数用于存储WiFi信号强度（RSSI）
+// 网络事件，由 WiFi 事件回调置位
+static const EventBits_t WIFI_GOT_IP_BIT = BIT0;
+static EventGroupHandle_t netEvents = NULL;
+
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info)
+{
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+  {
+    xEventGroupSetBits(netEvents, WIFI_GOT_IP_BIT);
+  }
+  else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED
+        || event == ARDUINO_EVENT_WIFI_STA_LOST_IP)
+  {
+    xEventGroupClearBits(netEvents, WIFI_GOT_IP_BIT);
+  }
+} // onWiFiEvent
+
+/* 阻塞等待直到指定事件位全部置位或到达截止时间（millis() 时间戳）
+ * 等待期间任务挂起，CPU 可进入空闲
  *
- * 返回WiFi连接状态
+ * 事件位全部置位返回true，超时返回false
  */
-wl_status_t startWiFi(int &wifiRSSI)
+static bool waitForNetEvent(EventBits_t bits, unsigned long deadline)
 {
-  WiFi.mode(WIFI_STA);
-  Serial.printf("%s '%s'", TXT_CONNECTING_TO, WIFI_SSID);
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  long remaining = static_cast<long>(deadline - millis());
+  TickType_t ticks = remaining > 0 ? pdMS_TO_TICKS(remaining) : 0;
+  EventBits_t set = xEventGroupWaitBits(netEvents, bits, pdFALSE, pdTRUE,
+                                        ticks);
+  return (set & bits) == bits;
+} // waitForNetEvent
+
+// 上次成功连接的接入点与 DHCP 租约，跨深度睡眠保存在 RTC 内存中。
+// 下次唤醒时据此直接连接指定 BSSID/信道并使用静态 IP，省去扫描与 DHCP。
+typedef struct {
+  bool     valid;
+  uint8_t  bssid[6];
+  int32_t  channel;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns1;
+  uint32_t dns2;
+  uint16_t reuseCount;  // 连续使用缓存租约（未经 DHCP）的次数
+} wifi_cache_t;
+
+static RTC_DATA_ATTR wifi_cache_t wifiCache = {};
+static bool fastConnect = false;
 
-  // 如果WiFi在WIFI_TIMEOUT毫秒内未连接则超时
-  unsigned long timeout = millis() + WIFI_TIMEOUT;
-  wl_status_t connection_status = WiFi.status();
+/* 缓存当前连接的接入点与租约信息 */
+static void saveWiFiCache()
+{
+  memcpy(wifiCache.bssid, WiFi.BSSID(), sizeof(wifiCache.bssid));
+  wifiCache.channel = WiFi.channel();
+  wifiCache.ip      = WiFi.localIP();
+  wifiCache.gateway = WiFi.gatewayIP();
+  wifiCache.subnet  = WiFi.subnetMask();
+  wifiCache.dns1    = WiFi.dnsIP(0);
+  wifiCache.dns2    = WiFi.dnsIP(1);
+  wifiCache.reuseCount = fastConnect ? wifiCache.reuseCount + 1 : 0;
+  wifiCache.valid   = true;
+} // saveWiFiCache
+
+/* 在超时前等待WiFi获取IP，返回最终连接状态 */
+static wl_status_t waitForConnection(unsigned long timeoutMs)
+{
+  waitForNetEvent(WIFI_GOT_IP_BIT, millis() + timeoutMs);
+  return WiFi.status();
+} // waitForConnection
+
+/* 启动WiFi连接，立即返回
+ * 关联与DHCP在后台进行，期间可并行初始化其他外设，之后调用waitForWiFi()
+ *
+ * 若RTC内存中有上次连接的缓存，则跳过扫描与DHCP直接连接。缓存租约连续使用
+ * WIFI_FAST_CONNECT_MAX_REUSE 次后走一次完整流程，以便向DHCP服务器续租。
+ */
+void beginWiFi()
+{
+  if (netEvents == NULL)
+  {
+    netEvents = xEventGroupCreate();
+    WiFi.onEvent(onWiFiEvent);
+  }
+  xEventGroupClearBits(netEvents, WIFI_GOT_IP_BIT);
+  WiFi.mode(WIFI_STA);
+  Serial.printf("%s '%s'\n", TXT_CONNECTING_TO, WIFI_SSID);
+  fastConnect = wifiCache.valid
+                && wifiCache.reuseCount < WIFI_FAST_CONNECT_MAX_REUSE;
+  if (fastConnect)
+  {
+    WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway),
+                IPAddress(wifiCache.subnet), IPAddress(wifiCache.dns1),
+                IPAddress(wifiCache.dns2));
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, wifiCache.channel, wifiCache.bssid);
+  }
+  else
+  {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  }
+} // beginWiFi
 
-  while ((connection_status != WL_CONNECTED) && (millis() < timeout))
+/* 等待beginWiFi()发起的连接完成
+ * 快速连接失败时自动清除缓存并回退到完整的扫描与DHCP流程。
+ * 接收一个int参数用于存储WiFi信号强度（RSSI）
+ *
+ * 返回WiFi连接状态
+ */
+wl_status_t waitForWiFi(int &wifiRSSI)
+{
+  wl_status_t connection_status = WL_IDLE_STATUS;
+  if (fastConnect)
   {
-    Serial.print(".");
-    delay(50);
-    connection_status = WiFi.status();
+    connection_status = waitForConnection(WIFI_FAST_CONNECT_TIMEOUT);
+    if (connection_status != WL_CONNECTED)
+    { // 接入点可能已更换信道或租约已失效
+      wifiCache.valid = false;
+      fastConnect = false;
+      WiFi.disconnect();
+      WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // 恢复DHCP
+      WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    }
+  }
+  if (!fastConnect)
+  {
+    // 如果WiFi在WIFI_TIMEOUT毫秒内未连接则超时
+    connection_status = waitForConnection(WIFI_TIMEOUT);
   }
-  Serial.println();
 
   if (connection_status == WL_CONNECTED)
   {
     wifiRSSI = WiFi.RSSI(); // 现在获取WiFi信号强度，因为WiFi将被关闭以节省电量！
     Serial.println("IP地址: " + WiFi.localIP().toString());
+    saveWiFiCache();
   }
   else
   {
     Serial.printf("%s '%s'\n", TXT_COULD_NOT_CONNECT_TO, WIFI_SSID);
   }
   return connection_status;
-} // startWiFi
+} // waitForWiFi
 
 /* 断开并关闭WiFi连接以节省电量
  */
@@ -106,7 +229,8 @@ bool printLocalTime(tm *timeInfo)
   return true;
 } // printLocalTime
 
-/* 等待NTP服务器时间同步，并根据config.cpp中指定的时区进行调整
+/* 从NTP服务器同步时间，并根据config.cpp中指定的时区进行调整
+ * 同时查询 NTP_SERVER_1 与 NTP_SERVER_2，采用先到的有效响应
  *
  * 如果时间设置成功则返回true，否则返回false
  *
@@ -114,89 +238,308 @@ bool printLocalTime(tm *timeInfo)
  */
 bool waitForSNTPSync(tm *timeInfo)
 {
-  // 等待SNTP同步完成
-  unsigned long timeout = millis() + NTP_TIMEOUT;
-  if ((sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET)
-      && (millis() < timeout))
-  {
-    Serial.print(TXT_WAITING_FOR_SNTP);
-    delay(100); // ms
-    while ((sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET)
-        && (millis() < timeout))
-    {
-      Serial.print(".");
-      delay(100); // ms
-    }
-    Serial.println();
+  Serial.println(TXT_WAITING_FOR_SNTP);
+  const char *const servers[] = {NTP_SERVER_1, NTP_SERVER_2};
+  if (!sntpSyncTime(servers, 2, NTP_TIMEOUT))
+  { // 缓存的地址可能已失效，下次重新解析
+    invalidateHost(NTP_SERVER_1);
+    invalidateHost(NTP_SERVER_2);
+    return false;
   }
   return printLocalTime(timeInfo);
 } // waitForSNTPSync
 
-/* 调用中国气象台天气预报API
- * 如果接收到数据，将解析并存入r参数中
+/* 请求失败的类别，决定是否重试、是否保留连接以及退避时长 */
+typedef enum {
+  HTTP_ERR_NONE,      // 成功
+  HTTP_ERR_TRANSPORT, // 域名解析或连接失败、连接断开：重新连接，较长退避
+  HTTP_ERR_TRUNCATED, // 读取超时或响应体不完整：连接状态未知，重新连接，短退避
+  HTTP_ERR_SERVER,    // 5xx、408、429：服务器暂时不可用，连接可复用，较长退避
+  HTTP_ERR_FATAL      // 其他 4xx、数据格式错误、内存不足等：重试无意义
+} http_error_class_t;
+
+static http_error_class_t classifyHttpResponse(int httpResponse)
+{
+  if (httpResponse == HTTP_CODE_OK)
+  {
+    return HTTP_ERR_NONE;
+  }
+  if (httpResponse >= 500 || httpResponse == HTTP_CODE_REQUEST_TIMEOUT
+   || httpResponse == HTTP_CODE_TOO_MANY_REQUESTS)
+  {
+    return HTTP_ERR_SERVER;
+  }
+  if (httpResponse > 0)
+  {
+    return HTTP_ERR_FATAL;
+  }
+  switch (httpResponse)
+  {
+    case HTTPC_ERROR_READ_TIMEOUT:
+    case -256 - DeserializationError::EmptyInput:
+    case -256 - DeserializationError::IncompleteInput:
+      return HTTP_ERR_TRUNCATED;
+    case -256 - DeserializationError::InvalidInput:
+    case -256 - DeserializationError::NoMemory:
+    case -256 - DeserializationError::TooDeep:
+    case HTTPC_ERROR_TOO_LESS_RAM:
+    case HTTPC_ERROR_ENCODING:
+      return HTTP_ERR_FATAL;
+    default:
+      return HTTP_ERR_TRANSPORT;
+  }
+} // end classifyHttpResponse
+
+/* 第 attempt 次失败后的退避时长（毫秒）：按类别取基数，指数增长并加入随机抖动，
+ * 避免大量设备在同一时刻重试
+ */
+static unsigned long retryBackoff(http_error_class_t errClass, int attempt)
+{
+  unsigned long base = errClass == HTTP_ERR_TRUNCATED ? HTTP_RETRY_BACKOFF / 4
+                                                      : HTTP_RETRY_BACKOFF;
+  unsigned long backoff = base << std::min(attempt - 1, 4);
+  // 抖动：取 [backoff/2, backoff] 内的随机值
+  return backoff / 2 + esp_random() % (backoff / 2 + 1);
+}
+
+/* 读完已知长度的响应体，使连接可用于下一次请求
  *
- * 返回HTTP状态码
+ * 长度未知或未能读完时返回false，此时连接上可能残留数据，不能复用
+ */
+static bool drainResponseBody(HTTPClient &http)
+{
+  int size = http.getSize();
+  Stream &body = http.getStream();
+  uint8_t buf[128];
+  while (size > 0)
+  {
+    size_t n = body.readBytes(buf, std::min<size_t>(size, sizeof(buf)));
+    if (n == 0)
+    {
+      return false;
+    }
+    size -= n;
+  }
+  return size == 0;
+} // drainResponseBody
+
+/* 请求一个地点的天气，如果接收到数据，将解析并存入r参数中
+ *
+ * 所有尝试须在 deadline（millis() 时间戳，全部地点共用）之前完成，每次尝试的超时
+ * 不超过剩余时间。连接仍然可用时复用，失败按类别决定是否重试及退避时长，剩余时间
+ * 不足时放弃。
+ *
+ * 返回HTTP状态码（多次尝试时为最后一次的结果）
  * 
  * 成功的状态码：
  *   200: HTTP_CODE_OK - 请求成功
  * 
  * 错误状态码：
  *   -512 ~ -520: WiFi连接错误（基于WiFi状态码偏移-512）
- *   -256 ~ -260: JSON解析错误（基于DeserializationError偏移-256）
+ *   -256 ~ -261: JSON解析错误（基于DeserializationError偏移-256）
  *   其他HTTP状态码: 标准HTTP错误码
  */
-#ifdef USE_HTTP
-  int getCMAweather(WiFiClient &client, cma_weather_t &r)
-#else
-  int getCMAweather(WiFiClientSecure &client, cma_weather_t &r)
-#endif
+static int fetchLocation(HTTPClient &http, cma_client_t &client,
+                         const cma_location_t &loc, cma_weather_t &r,
+                         unsigned long deadline)
 {
-  int attempts = 0;
-  bool rxSuccess = false;
-  DeserializationError jsonErr = {};
+#if DEBUG_LEVEL >= 1
+  const unsigned long fetchStart = millis();
+#endif
+  const uint16_t port = CMA_PORT != 0 ? CMA_PORT : CMA_DEFAULT_PORT;
   // 构造请求URI
+  String query = String("&sheng=") + loc.province + "&shi=" + loc.city
+                 + "&place=" + loc.place;
   String uri = String("/api/tianqi/tqyb.php?pid=") + CMA_PID + "&key=" + CMA_KEY
-                + "&sheng=" + CMA_PROVINCE + "&shi=" + CMA_CITY
-                + "&place=" + CMA_PLACE;
+               + query;
 
   String sanitizedUri = String(CMA_ENDPOINT) +
                         "/api/tianqi/tqyb.php?pid=" + CMA_PID + "&key={KEY}"
-                        + "&sheng=" + CMA_PROVINCE + "&shi=" + CMA_CITY
-                        + "&place=" + CMA_PLACE;
+                        + query;
 
   Serial.print(TXT_ATTEMPTING_HTTP_REQ);
   Serial.println("：" + sanitizedUri);
+
+  const char *responseHeaders[] = {"Content-Encoding"};
+  http.collectHeaders(responseHeaders, 1);
   int httpResponse = 0;
-  while (!rxSuccess && attempts < 3)
+  int attempt = 0;
+  for (;;)
   {
+    ++attempt;
     wl_status_t connection_status = WiFi.status();
     if (connection_status != WL_CONNECTED)
     {
       // -512 offset distinguishes these errors from httpClient errors
-      return -512 - static_cast<int>(connection_status);
+      httpResponse = -512 - static_cast<int>(connection_status);
+      break;
+    }
+
+    long remaining = static_cast<long>(deadline - millis());
+    if (remaining < static_cast<long>(HTTP_MIN_ATTEMPT_TIME))
+    { // 之前的地点已用完总时限
+      httpResponse = HTTPC_ERROR_READ_TIMEOUT;
+      break;
+    }
+    unsigned timeout = std::min<unsigned long>(HTTP_CLIENT_TCP_TIMEOUT,
+                                               remaining);
+    http.setConnectTimeout(timeout);
+    http.setTimeout(timeout);
+    // begin() 不会断开仍然可用的连接；请求头会被 begin() 与 getString() 清除，
+    // 每次尝试都要重新添加
+    http.begin(client, CMA_ENDPOINT, port, uri);
+    http.addHeader("Accept-Encoding", "gzip, deflate");
+
+    // 连接已断开时，先行解析域名并建立连接，以便分别统计 DNS 与 TLS 握手耗时。
+    // 随后 HTTPClient 检测到连接已建立，会直接复用。
+    bool connected = client.connected();
+#if DEBUG_LEVEL >= 1
+    ++(connected ? connReused : connReconnect);
+#endif
+    if (!connected)
+    {
+      IPAddress ip;
+      profilerStart(PROF_HTTP_DNS);
+      bool resolved = resolveHost(CMA_ENDPOINT.c_str(), ip);
+      profilerStop(PROF_HTTP_DNS);
+      profilerStart(PROF_HTTP_CONNECT);
+#ifdef USE_HTTP
+      connected = resolved && client.connect(ip, port, timeout);
+#else
+      client.setHandshakeTimeout((timeout + 999) / 1000);
+      connected = resolved && client.connect(ip, port,
+                                             CMA_ENDPOINT.c_str(), timeout);
+#endif
+      profilerStop(PROF_HTTP_CONNECT);
+      if (resolved && !connected)
+      { // 缓存的地址可能已失效，下次尝试重新解析
+        invalidateHost(CMA_ENDPOINT.c_str());
+      }
     }
 
-    HTTPClient http;
-    http.setConnectTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
-    http.setTimeout(HTTP_CLIENT_TCP_TIMEOUT); // default 5000ms
-    http.begin(client, CMA_ENDPOINT, CMA_PORT, uri);
-    httpResponse = http.GET();
+    if (connected)
+    {
+      profilerStart(PROF_HTTP_FIRST_BYTE);
+      httpResponse = http.GET();
+      profilerStop(PROF_HTTP_FIRST_BYTE);
+    }
+    else
+    {
+      httpResponse = HTTPC_ERROR_CONNECTION_REFUSED;
+    }
     if (httpResponse == HTTP_CODE_OK)
     {
-      jsonErr = deserializeCMAWeather(http.getStream(), r);
+      profilerStart(PROF_HTTP_BODY_PARSE);
+      DeserializationError jsonErr;
+      content_encoding_t encoding =
+        parseContentEncoding(http.header("Content-Encoding"));
+      if (encoding == CONTENT_IDENTITY)
+      {
+        jsonErr = deserializeCMAWeather(http.getStream(), r);
+      }
+      else
+      { // 压缩格式无效按响应不完整处理，断开重试
+        InflateStream inflated(http.getStream(), encoding);
+        jsonErr = inflated.begin()
+                  ? deserializeCMAWeather(inflated, r)
+                  : DeserializationError::IncompleteInput;
+      }
+      profilerStop(PROF_HTTP_BODY_PARSE);
       if (jsonErr)
       {
         // -256 offset distinguishes these errors from httpClient errors
         httpResponse = -256 - static_cast<int>(jsonErr.code());
       }
-      rxSuccess = !jsonErr;
+#ifndef USE_HTTP
+      else
+      { // 保存 TLS 会话，下次唤醒时简短握手
+        client.saveSession();
+      }
+#endif
+    }
+    if (httpResponse == HTTP_CODE_OK)
+    { // 丢弃已到达的剩余响应体；服务器同意保持连接时留给下一个地点，
+      // 否则断开，下一个地点重新连接
+      http.end();
     }
-    client.stop();
-    http.end();
     Serial.println("  " + String(httpResponse, DEC) + " "
                     + getHttpResponsePhrase(httpResponse));
-    ++attempts;
+
+    http_error_class_t errClass = classifyHttpResponse(httpResponse);
+    if (errClass == HTTP_ERR_NONE)
+    {
+      break;
+    }
+    // 未读完的响应体（解析出错、4xx 等）会混入同一连接上下一次请求的响应。
+    // 只有完整读完的错误响应体（服务器暂时不可用）才保留连接，其余一律断开
+    if (errClass != HTTP_ERR_SERVER || !drainResponseBody(http))
+    {
+      client.stop();
+    }
+    if (errClass == HTTP_ERR_FATAL)
+    {
+      break;
+    }
+
+    unsigned long backoff = retryBackoff(errClass, attempt);
+    remaining = static_cast<long>(deadline - millis());
+    if (remaining <= 0
+     || static_cast<unsigned long>(remaining) < backoff + HTTP_MIN_ATTEMPT_TIME)
+    {
+      break;
+    }
+    delay(backoff);
   }
 
+#if DEBUG_LEVEL >= 1
+  // 单行统计，便于对照不同网络状况或服务器行为收集比较
+  Serial.printf("FETCH status=%d attempts=%d ms=%lu minheap=%u maxblock=%u\n",
+                httpResponse, attempt, millis() - fetchStart,
+                ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
+#endif
   return httpResponse;
+} // fetchLocation
+
+/* 调用中国气象台天气预报API，依次请求 CMA_LOCATIONS 中的全部地点
+ *
+ * 各地点按顺序请求（不并发），复用同一个（keep-alive）连接，服务器关闭连接时自动
+ * 重新连接（HTTPS 下以恢复的 TLS 会话简短握手）。全部地点共用 HTTP_REQUEST_DEADLINE
+ * 的总时限。结果存入r[i]，HTTP状态码存入status[i]。
+ * 主地点（第一个）失败时不再请求其余地点。
+ *
+ * 返回主地点的HTTP状态码
+ */
+#ifdef USE_HTTP
+  int getCMAweather(WiFiClient &client, cma_weather_t r[], int status[])
+#else
+  int getCMAweather(ResumableClientSecure &client, cma_weather_t r[],
+                    int status[])
+#endif
+{
+  HTTPClient http;
+  // HTTP/1.1 下 HTTPClient 固定发送 "Accept-Encoding: identity"，改用 HTTP/1.0
+  // 自行声明，同时避免分块传输。useHTTP10() 会关闭连接复用，须在其后重新开启，
+  // 请求中随之带上 "Connection: keep-alive"
+  http.useHTTP10(true);
+  http.setReuse(true);
+  const unsigned long deadline = millis() + HTTP_REQUEST_DEADLINE;
+  for (size_t i = 0; i < CMA_LOCATION_COUNT; ++i)
+  {
+    status[i] = fetchLocation(http, client, CMA_LOCATIONS[i], r[i], deadline);
+    if (i == 0 && status[i] != HTTP_CODE_OK)
+    {
+      for (size_t j = 1; j < CMA_LOCATION_COUNT; ++j)
+      {
+        status[j] = status[0];
+      }
+      break;
+    }
+  }
+  http.end();
+  client.stop();
+#if DEBUG_LEVEL >= 1
+  Serial.printf("KEEPALIVE reused=%u reconnected=%u\n",
+                connReused, connReconnect);
+#endif
+  return status[0];
 } // getCMAweather
\ No newline at end of file
@@ -0,0 +1,238 @@
+/* 中国气象台风向、风力与天气现象编码
+ *
+ * 天气现象文字通过编译期生成的查找表映射为数字代码：表项按文字的 FNV-1a 哈希排序，
+ * 查找时对输入计算一次哈希，二分查找后再比较文字确认。风向与风力各扫描一遍 UTF-8
+ * 码点得出，渲染时无需再做字符串处理。
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <Arduino.h>
+
+#include "cma_codes.h"
+
+typedef struct {
+  const char        *text;
+  cma_weather_code_t code;
+} weather_name_t;
+
+static constexpr weather_name_t WEATHER_NAMES[] = {
+  {"晴",               WX_SUNNY},
+  {"多云",             WX_CLOUDY},
+  {"阴",               WX_OVERCAST},
+  {"阵雨",             WX_SHOWER},
+  {"雷阵雨",           WX_THUNDERSHOWER},
+  {"雷阵雨伴有冰雹",   WX_THUNDERSHOWER_HAIL},
+  {"雨夹雪",           WX_SLEET},
+  {"小雨",             WX_LIGHT_RAIN},
+  {"中雨",             WX_MODERATE_RAIN},
+  {"大雨",             WX_HEAVY_RAIN},
+  {"暴雨",             WX_STORM},
+  {"大暴雨",           WX_HEAVY_STORM},
+  {"特大暴雨",         WX_SEVERE_STORM},
+  {"阵雪",             WX_SNOW_FLURRY},
+  {"小雪",             WX_LIGHT_SNOW},
+  {"中雪",             WX_MODERATE_SNOW},
+  {"大雪",             WX_HEAVY_SNOW},
+  {"暴雪",             WX_SNOWSTORM},
+  {"雾",               WX_FOG},
+  {"冻雨",             WX_ICE_RAIN},
+  {"沙尘暴",           WX_DUSTSTORM},
+  {"小到中雨",         WX_LIGHT_TO_MODERATE_RAIN},
+  {"中到大雨",         WX_MODERATE_TO_HEAVY_RAIN},
+  {"大到暴雨",         WX_HEAVY_RAIN_TO_STORM},
+  {"暴雨到大暴雨",     WX_STORM_TO_HEAVY_STORM},
+  {"大暴雨到特大暴雨", WX_HEAVY_TO_SEVERE_STORM},
+  {"小到中雪",         WX_LIGHT_TO_MODERATE_SNOW},
+  {"中到大雪",         WX_MODERATE_TO_HEAVY_SNOW},
+  {"大到暴雪",         WX_HEAVY_SNOW_TO_SNOWSTORM},
+  {"浮尘",             WX_DUST},
+  {"扬沙",             WX_SAND},
+  {"强沙尘暴",         WX_SANDSTORM},
+  {"浓雾",             WX_DENSE_FOG},
+  {"强浓雾",           WX_STRONG_DENSE_FOG},
+  {"霾",               WX_HAZE},
+  {"中度霾",           WX_MODERATE_HAZE},
+  {"重度霾",           WX_SEVERE_HAZE},
+  {"严重霾",           WX_EXTREME_HAZE},
+  {"大雾",             WX_HEAVY_FOG},
+  {"特强浓雾",         WX_EXTRA_HEAVY_FOG},
+};
+static constexpr size_t WEATHER_NAME_COUNT =
+  sizeof(WEATHER_NAMES) / sizeof(WEATHER_NAMES[0]);
+
+static constexpr uint32_t fnv1a32(const char *s)
+{
+  uint32_t hash = 2166136261u;
+  while (*s)
+  {
+    hash = (hash ^ static_cast<uint8_t>(*s++)) * 16777619u;
+  }
+  return hash;
+}
+
+typedef struct {
+  uint32_t hash;
+  uint8_t  index; // WEATHER_NAMES 中的下标
+} weather_hash_t;
+
+/* 编译期按哈希排序的查找表 */
+static constexpr std::array<weather_hash_t, WEATHER_NAME_COUNT>
+buildWeatherTable()
+{
+  std::array<weather_hash_t, WEATHER_NAME_COUNT> table = {};
+  for (size_t i = 0; i < WEATHER_NAME_COUNT; ++i)
+  {
+    weather_hash_t entry = {fnv1a32(WEATHER_NAMES[i].text),
+                            static_cast<uint8_t>(i)};
+    size_t j = i;
+    for (; j > 0 && table[j - 1].hash > entry.hash; --j)
+    {
+      table[j] = table[j - 1];
+    }
+    table[j] = entry;
+  }
+  return table;
+}
+
+static constexpr std::array<weather_hash_t, WEATHER_NAME_COUNT>
+  WEATHER_TABLE = buildWeatherTable();
+
+static constexpr bool hashesUnique()
+{
+  for (size_t i = 1; i < WEATHER_NAME_COUNT; ++i)
+  {
+    if (WEATHER_TABLE[i].hash == WEATHER_TABLE[i - 1].hash)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(hashesUnique(), "天气现象文字的哈希冲突");
+
+/* 解码 p 处的一个 UTF-8 字符并前移 p，字符串结束返回 0，无效字节返回 U+FFFD
+ */
+uint32_t utf8Next(const char *&p)
+{
+  uint8_t c = static_cast<uint8_t>(*p);
+  if (c == 0)
+  {
+    return 0;
+  }
+  ++p;
+  int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+  if (c >= 0x80 && extra == 0)
+  {
+    return 0xFFFD; // 孤立的后续字节
+  }
+  uint32_t cp = extra == 0 ? c : c & (0x3F >> extra);
+  for (int i = 0; i < extra; ++i)
+  {
+    uint8_t cc = static_cast<uint8_t>(*p);
+    if ((cc & 0xC0) != 0x80)
+    {
+      return 0xFFFD; // 截断的序列，不越过结尾
+    }
+    cp = (cp << 6) | (cc & 0x3F);
+    ++p;
+  }
+  return cp;
+}
+
+/* 天气现象文字 → 代码，无法识别时返回 WX_UNKNOWN */
+cma_weather_code_t lookupWeatherCode(const char *text)
+{
+  uint32_t hash = fnv1a32(text);
+  size_t lo = 0, hi = WEATHER_NAME_COUNT;
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (WEATHER_TABLE[mid].hash < hash)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  if (lo < WEATHER_NAME_COUNT && WEATHER_TABLE[lo].hash == hash)
+  {
+    const weather_name_t &name = WEATHER_NAMES[WEATHER_TABLE[lo].index];
+    if (strcmp(name.text, text) == 0)
+    {
+      return name.code;
+    }
+  }
+  return WX_UNKNOWN;
+}
+
+/* 风向文字 → 角度（0 为北，顺时针），无法识别（如"静风"、"无持续风向"）时返回 -1
+ *
+ * 将文字中每个方位字的单位向量相加后取方向，"东北"得 45°，"西南偏西"约 243°。
+ */
+int16_t parseWindDegree(const char *text)
+{
+  int x = 0, y = 0;
+  for (uint32_t cp; (cp = utf8Next(text)) != 0; )
+  {
+    switch (cp)
+    {
+      case U'北': ++y; break;
+      case U'南': --y; break;
+      case U'东': ++x; break;
+      case U'西': --x; break;
+    }
+  }
+  if (x == 0 && y == 0)
+  {
+    return -1;
+  }
+  int deg = lroundf(atan2f(x, y) * 180.0f / static_cast<float>(M_PI));
+  return (deg + 360) % 360;
+}
+
+/* 风力描述 → 等级，如"3级"得 3，"3-4级"取较大值 4，"<3级"与"微风"得 2，
+ * 无法识别时返回 WIND_SCALE_UNKNOWN
+ */
+uint8_t parseWindScale(const char *text)
+{
+  int level = -1, number = -1;
+  bool lessThan = false, breeze = false;
+  for (uint32_t cp; (cp = utf8Next(text)) != 0; )
+  {
+    if (cp >= '0' && cp <= '9')
+    {
+      number = (number < 0 ? 0 : number * 10) + (cp - '0');
+      continue;
+    }
+    if (number >= 0)
+    {
+      level = number;
+      number = -1;
+    }
+    if (cp == '<' || cp == U'小' || cp == U'＜')
+    {
+      lessThan = true;
+    }
+    else if (cp == U'微')
+    {
+      breeze = true;
+    }
+  }
+  if (number >= 0)
+  {
+    level = number;
+  }
+  if (level < 0)
+  {
+    return breeze ? 2 : WIND_SCALE_UNKNOWN;
+  }
+  if (lessThan && level > 0)
+  {
+    --level;
+  }
+  return std::min(level, 17);
+}
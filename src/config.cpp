@@ -36,11 +36,20 @@ const uint8_t PIN_I2C_SDA = 17;
 const uint8_t PIN_I2C_SCL = 16;
 const uint8_t SHT30_ADDRESS = 0x44; // SHT30 默认地址
 const uint8_t RTC_ADDRESS   = 0x51; // BL8025C/PCF8563 地址
+// 外部 RTC 的 INT 输出（开漏，需外部上拉），仅在 WAKE_FROM_EXT_RTC 启用时使用。
+// 必须是支持深度睡眠唤醒的 RTC GPIO。
+const uint8_t PIN_RTC_INT = 33;
 
 // WIFI
 const char *WIFI_SSID     = "ssid";
 const char *WIFI_PASSWORD = "password";
 const unsigned long WIFI_TIMEOUT = 10000; // 毫秒，WiFi 连接超时时间
+// 快速重连：使用 RTC 内存中缓存的 BSSID、信道与 IP 租约直接连接，跳过扫描与 DHCP。
+// 若在 WIFI_FAST_CONNECT_TIMEOUT 内未连上，则自动回退到完整连接流程。
+// 缓存租约连续使用 WIFI_FAST_CONNECT_MAX_REUSE 次后会重新走一次 DHCP 以续租，
+// 设为 0 可禁用快速重连。
+const unsigned long WIFI_FAST_CONNECT_TIMEOUT = 3000; // 毫秒
+const unsigned WIFI_FAST_CONNECT_MAX_REUSE = 48;
 
 // HTTP
 // 下列错误通常是由于 http 客户端 tcp 超时不足导致：
@@ -48,15 +57,38 @@ const unsigned long WIFI_TIMEOUT = 10000; // 毫秒，WiFi 连接超时时间
 //   -11  读取超时
 //   -258 反序列化输入不完整
 const unsigned HTTP_CLIENT_TCP_TIMEOUT = 10000; // 毫秒
+// 一次唤醒中全部地点的天气请求（含全部重试）的总时限，每次尝试的超时不超过剩余时间。
+// 失败后按指数退避（加随机抖动）重试，HTTP_RETRY_BACKOFF 为首次退避的基数。
+const unsigned long HTTP_REQUEST_DEADLINE = 20000; // 毫秒
+const unsigned long HTTP_RETRY_BACKOFF    = 1000;  // 毫秒
+// HTTPS 模式下，TLS 会话保存在 RTC 内存中，下次唤醒时用于简短握手。
+// 会话在服务器给出的票据有效期或 TLS_SESSION_MAX_AGE（取较短者）后失效。
+const unsigned long TLS_SESSION_MAX_AGE = 12 * 3600; // 秒
+// API 与 NTP 服务器的域名解析结果保存在 RTC 内存中，DNS_CACHE_TTL 内不再解析，
+// 用缓存地址连接失败时立即重新解析。设为 0 以禁用。
+const unsigned long DNS_CACHE_TTL = 6 * 3600; // 秒
 
 // 中国气象台 API
 // 参考：https://cn.apihz.cn/api/tianqi/tqyb.php
 const String CMA_PID      = "your_pid";        // 用户 PID
 const String CMA_KEY      = "your_key";        // 用户 KEY
-const String CMA_PROVINCE = "省份";           // 省
-const String CMA_CITY     = "城市";           // 市
-const String CMA_PLACE    = "区县";           // 区/县
 const String CMA_ENDPOINT = "cn.apihz.cn";    // 接口域名
+// 天气地点（最多 CMA_MAX_LOCATIONS 个）。第一个为主地点，详细显示在屏幕上方；
+// 其余各以一个小卡片显示在下方。所有地点在同一个连接上依次请求。
+const cma_location_t CMA_LOCATIONS[] = {
+  {"省份", "城市", "区县", "家"},
+  // {"省份", "城市", "区县", "公司"},
+  // {"省份", "城市", "区县", "父母家"},
+};
+const size_t CMA_LOCATION_COUNT = sizeof(CMA_LOCATIONS)
+                                  / sizeof(CMA_LOCATIONS[0]);
+static_assert(sizeof(CMA_LOCATIONS) / sizeof(CMA_LOCATIONS[0])
+              <= CMA_MAX_LOCATIONS, "CMA_LOCATIONS 最多 4 个地点");
+// 接口端口，0 表示按传输协议使用默认端口（HTTP 为 80，HTTPS 为 443）。
+// 调试时可将 CMA_ENDPOINT 与 CMA_PORT 指向局域网内的模拟服务器
+// （test/mock_cma_server.py，需定义 USE_HTTP），配合 DEBUG_LEVEL >= 1 输出的
+// FETCH 统计行比较各种网络状况下的表现。
+const uint16_t CMA_PORT   = 0;
 
 // 位置
 // 设置你的纬度和经度。
@@ -92,8 +124,14 @@ const char *REFRESH_TIME_FORMAT = "%x %H:%M";
 // pool.ntp.org 会自动选择离你最近的 NTP 服务器。
 const char *NTP_SERVER_1 = "pool.ntp.org";
 const char *NTP_SERVER_2 = "time.nist.gov";
+// 两个服务器同时查询，未收到响应时每秒重发一次。
 // 若遇到 'Failed To Fetch The Time' 错误，可尝试增加 NTP_TIMEOUT 或选择更近/延迟更低的时间服务器。
-const unsigned long NTP_TIMEOUT = 20000; // 毫秒
+const unsigned long NTP_TIMEOUT = 5000; // 毫秒
+// SNTP 同步成功后会把时间写入外部 RTC 并测量其漂移。之后若按漂移估计的误差上限
+// 不超过 EXT_RTC_MAX_ERROR，且距上次 SNTP 同步不足 NTP_RESYNC_INTERVAL 次唤醒，
+// 则直接使用外部 RTC 时间，跳过 SNTP。设 NTP_RESYNC_INTERVAL 为 0 则每次都同步。
+const unsigned EXT_RTC_MAX_ERROR   = 5;  // 秒
+const unsigned NTP_RESYNC_INTERVAL = 48; // 次唤醒
 // 睡眠时长（分钟），即 esp32 唤醒更新的频率。
 // 对齐到最近的分钟边界。
 // 例如，设为 30（分钟），则显示将在每小时的 00 或 30 分钟更新。（范围：[2-1440]）
@@ -108,6 +146,28 @@ const int WAKE_TIME = 06; // 睡眠后首次更新的小时，06:00。
 // 例如，WAKE_TIME = 00（午夜），SLEEP_DURATION = 120，则显示将在 00:00、02:00、04:00... 更新，直到 BED_TIME。
 // 若希望每天仅刷新一次，可设 SLEEP_DURATION = 1440，并通过 BED_TIME 和 WAKE_TIME 设置每天刷新时间。
 
+// 自适应刷新间隔（见 config.h 中的 ADAPTIVE_SLEEP）
+// 启用后 SLEEP_DURATION 不再使用，刷新间隔在 [ADAPTIVE_SLEEP_MIN, ADAPTIVE_SLEEP_MAX]
+// 之间自动选择，使电池从当前电量用到 LOW_BATTERY_VOLTAGE 恰好持续到续航目标结束。
+// 续航目标从装入满电电池（或充电）时开始计算。
+// AWAKE_CURRENT 与 SLEEP_CURRENT 只需大致准确，偏差会由实测的电量趋势修正。
+const uint32_t BATTERY_CAPACITY = 5000; // 毫安时
+const unsigned TARGET_RUNTIME   = 180;  // 天
+const float AWAKE_CURRENT       = 80;   // 毫安，唤醒期间平均电流
+const float SLEEP_CURRENT       = 15;   // 微安，深度睡眠电流（含外设）
+const int ADAPTIVE_SLEEP_MIN    = 15;   // 分钟
+const int ADAPTIVE_SLEEP_MAX    = 240;  // 分钟
+
+// 内容未变化时跳过刷新
+// 每次唤醒都会对将要显示的内容（不含刷新时间）计算哈希，与上次刷新时相同则跳过
+// 墨水屏刷新。为避免状态栏中的刷新时间过旧，连续跳过 FORCE_REFRESH_INTERVAL 次后
+// 强制刷新一次。设为 0 则每次都刷新。
+const unsigned FORCE_REFRESH_INTERVAL = 3; // 次唤醒
+
+// 局部刷新（见 config.h 中的 PARTIAL_REFRESH）
+// 连续局部刷新多少次后进行一次全屏刷新，以清除残影。设为 0 则总是全屏刷新。
+const unsigned PARTIAL_REFRESH_FULL_EVERY = 12; // 次刷新
+
 // 小时趋势图
 // 趋势图显示的小时数（范围：[8-48]）
 const int HOURLY_GRAPH_MAX = 24;
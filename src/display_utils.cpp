@@ -48,6 +48,124 @@ const uint8_t *getBatBitmap24(uint32_t batPercent)
   else                      { return battery_0_bar_90deg_24x24; }
 }
 
+// 天气图标种类，多个天气现象代码共用一种图标
+typedef enum {
+  WI_SUNNY,
+  WI_PARTLY_CLOUDY,
+  WI_CLOUDY,
+  WI_SHOWERS,
+  WI_THUNDERSTORM,
+  WI_HAIL,
+  WI_SLEET,
+  WI_RAIN,
+  WI_HEAVY_RAIN,
+  WI_SNOW,
+  WI_HEAVY_SNOW,
+  WI_FOG,
+  WI_SANDSTORM,
+  WI_DUST,
+  WI_HAZE,
+  WI_NA,
+  WI_COUNT
+} weather_icon_t;
+
+/* 天气现象代码对应的图标种类 */
+static weather_icon_t getWeatherIcon(cma_weather_code_t code)
+{
+  switch (code)
+  {
+    case WX_SUNNY:                   return WI_SUNNY;
+    case WX_CLOUDY:                  return WI_PARTLY_CLOUDY;
+    case WX_OVERCAST:                return WI_CLOUDY;
+    case WX_SHOWER:                  return WI_SHOWERS;
+    case WX_THUNDERSHOWER:           return WI_THUNDERSTORM;
+    case WX_THUNDERSHOWER_HAIL:      return WI_HAIL;
+    case WX_SLEET:
+    case WX_ICE_RAIN:                return WI_SLEET;
+    case WX_LIGHT_RAIN:
+    case WX_MODERATE_RAIN:
+    case WX_LIGHT_TO_MODERATE_RAIN:  return WI_RAIN;
+    case WX_HEAVY_RAIN:
+    case WX_STORM:
+    case WX_HEAVY_STORM:
+    case WX_SEVERE_STORM:
+    case WX_MODERATE_TO_HEAVY_RAIN:
+    case WX_HEAVY_RAIN_TO_STORM:
+    case WX_STORM_TO_HEAVY_STORM:
+    case WX_HEAVY_TO_SEVERE_STORM:   return WI_HEAVY_RAIN;
+    case WX_SNOW_FLURRY:
+    case WX_LIGHT_SNOW:
+    case WX_MODERATE_SNOW:
+    case WX_LIGHT_TO_MODERATE_SNOW:  return WI_SNOW;
+    case WX_HEAVY_SNOW:
+    case WX_SNOWSTORM:
+    case WX_MODERATE_TO_HEAVY_SNOW:
+    case WX_HEAVY_SNOW_TO_SNOWSTORM: return WI_HEAVY_SNOW;
+    case WX_FOG:
+    case WX_DENSE_FOG:
+    case WX_STRONG_DENSE_FOG:
+    case WX_HEAVY_FOG:
+    case WX_EXTRA_HEAVY_FOG:         return WI_FOG;
+    case WX_DUSTSTORM:
+    case WX_SANDSTORM:               return WI_SANDSTORM;
+    case WX_DUST:
+    case WX_SAND:                    return WI_DUST;
+    case WX_HAZE:
+    case WX_MODERATE_HAZE:
+    case WX_SEVERE_HAZE:
+    case WX_EXTREME_HAZE:            return WI_HAZE;
+    default:                         return WI_NA;
+  }
+}
+
+/* 根据天气现象代码获取 96x96 天气图标 */
+const uint8_t *getWeatherBitmap96(cma_weather_code_t code)
+{
+  static const uint8_t *const bitmaps[WI_COUNT] = {
+    wi_day_sunny_96x96,
+    wi_day_cloudy_96x96,
+    wi_cloudy_96x96,
+    wi_showers_96x96,
+    wi_thunderstorm_96x96,
+    wi_hail_96x96,
+    wi_sleet_96x96,
+    wi_rain_96x96,
+    wi_rain_wind_96x96,
+    wi_snow_96x96,
+    wi_snow_wind_96x96,
+    wi_fog_96x96,
+    wi_sandstorm_96x96,
+    wi_dust_96x96,
+    wi_day_haze_96x96,
+    wi_na_96x96,
+  };
+  return bitmaps[getWeatherIcon(code)];
+}
+
+/* 根据天气现象代码获取 48x48 天气图标 */
+const uint8_t *getWeatherBitmap48(cma_weather_code_t code)
+{
+  static const uint8_t *const bitmaps[WI_COUNT] = {
+    wi_day_sunny_48x48,
+    wi_day_cloudy_48x48,
+    wi_cloudy_48x48,
+    wi_showers_48x48,
+    wi_thunderstorm_48x48,
+    wi_hail_48x48,
+    wi_sleet_48x48,
+    wi_rain_48x48,
+    wi_rain_wind_48x48,
+    wi_snow_48x48,
+    wi_snow_wind_48x48,
+    wi_fog_48x48,
+    wi_sandstorm_48x48,
+    wi_dust_48x48,
+    wi_day_haze_48x48,
+    wi_na_48x48,
+  };
+  return bitmaps[getWeatherIcon(code)];
+}
+
 /* 获取当前日期字符串 */
 void getDateStr(String &s, tm *timeInfo)
 {
@@ -115,6 +233,17 @@ const char *getWifiStatusPhrase(wl_status_t status)
   }
 }
 
+/* FNV-1a 32 位哈希，可通过 hash 参数对多段数据连续计算 */
+uint32_t fnv1a32(const void *data, size_t len, uint32_t hash)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < len; ++i)
+  {
+    hash = (hash ^ p[i]) * 16777619u;
+  }
+  return hash;
+}
+
 /* 打印堆内存使用情况 */
 void printHeapUsage()
 {
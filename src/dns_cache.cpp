@@ -0,0 +1,103 @@
+/* 跨深度睡眠的 DNS 解析缓存
+ *
+ * 每次唤醒都要解析 API 与 NTP 服务器的域名，各需一次 DNS 往返。解析结果连同
+ * 过期时间保存在 RTC 内存中，有效期内直接使用。lwIP 的解析接口不提供记录的 TTL，
+ * 有效期统一取 DNS_CACHE_TTL；使用缓存地址连接失败时应调用 invalidateHost()，
+ * 下次重新解析。
+ */
+#include <cstring>
+#include <Arduino.h>
+#include <time.h>
+#include <WiFi.h>
+
+#include "config.h"
+#include "display_utils.h"
+#include "dns_cache.h"
+
+static const uint8_t DNS_CACHE_SIZE = 4;
+// 早于此时间说明系统时间未设置，无法判断记录是否过期
+static const time_t MIN_VALID_EPOCH = 1700000000;
+
+typedef struct {
+  uint32_t key;     // 域名的哈希，0 表示空
+  uint32_t addr;
+  time_t   expires; // 过期时间（UTC）
+} dns_cache_entry_t;
+
+static RTC_DATA_ATTR dns_cache_entry_t dnsCache[DNS_CACHE_SIZE];
+
+static uint32_t hostKey(const char *host)
+{
+  uint32_t key = fnv1a32(host, strlen(host));
+  return key == 0 ? 1 : key;
+}
+
+static dns_cache_entry_t *findEntry(uint32_t key)
+{
+  for (dns_cache_entry_t &e : dnsCache)
+  {
+    if (e.key == key)
+    {
+      return &e;
+    }
+  }
+  return NULL;
+}
+
+/* 解析域名，优先使用缓存。成功返回true
+ */
+bool resolveHost(const char *host, IPAddress &ip)
+{
+  uint32_t key = hostKey(host);
+  time_t now = time(NULL);
+  bool clockValid = now >= MIN_VALID_EPOCH;
+  dns_cache_entry_t *entry = findEntry(key);
+  if (entry != NULL && clockValid && now < entry->expires)
+  {
+    ip = IPAddress(entry->addr);
+#if DEBUG_LEVEL >= 1
+    Serial.printf("DNS 缓存：%s → %s\n", host, ip.toString().c_str());
+#endif
+    return true;
+  }
+
+  if (!WiFi.hostByName(host, ip))
+  {
+    return false;
+  }
+  if (DNS_CACHE_TTL == 0 || !clockValid)
+  {
+    return true;
+  }
+  if (entry == NULL)
+  { // 使用空位，没有空位时替换最早过期的记录
+    entry = &dnsCache[0];
+    for (dns_cache_entry_t &e : dnsCache)
+    {
+      if (e.key == 0)
+      {
+        entry = &e;
+        break;
+      }
+      if (e.expires < entry->expires)
+      {
+        entry = &e;
+      }
+    }
+  }
+  entry->key     = key;
+  entry->addr    = ip;
+  entry->expires = now + DNS_CACHE_TTL;
+  return true;
+} // end resolveHost
+
+/* 丢弃域名的缓存记录，用于缓存地址连接失败之后
+ */
+void invalidateHost(const char *host)
+{
+  dns_cache_entry_t *entry = findEntry(hostKey(host));
+  if (entry != NULL)
+  {
+    entry->key = 0;
+  }
+} // end invalidateHost
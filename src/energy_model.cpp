@@ -0,0 +1,199 @@
+/* 能耗模型：按电池续航目标自动选择刷新间隔
+ *
+ * 每次唤醒的耗电量按唤醒时长（指数加权平均）乘以 AWAKE_CURRENT 估计，睡眠期间按
+ * SLEEP_CURRENT 估计。电池剩余可用电量平均分配到距续航目标结束的剩余天数上，由此
+ * 算出每天可负担的唤醒次数，再换算为刷新间隔。
+ *
+ * 模型与实际耗电的偏差由电池电量趋势修正：每隔至少一天，比较电量的实际下降与模型
+ * 预测的下降，两者之比（指数加权平均，保存在 NVS 中）作为修正系数。实际耗电快于
+ * 计划时间隔随之变长。天气变化剧烈时间隔缩短一半。
+ *
+ * 间隔取 ADAPTIVE_SLEEP_STEPS 中不小于计算结果的最小值，以保持与 WAKE_TIME 的分钟对齐。
+ */
+#include <algorithm>
+#include <cmath>
+#include <Arduino.h>
+#include <Preferences.h>
+#include <time.h>
+
+#include "config.h"
+#include "display_utils.h"
+#include "energy_model.h"
+
+// 可选的刷新间隔（分钟），均为 1440 的约数
+static const int ADAPTIVE_SLEEP_STEPS[] = {10, 15, 20, 30, 40, 60, 90, 120,
+                                           180, 240, 360, 480, 720, 1440};
+
+/* 取 ADAPTIVE_SLEEP_STEPS 中不小于 interval（分钟）的最小值，限制在
+ * [ADAPTIVE_SLEEP_MIN, ADAPTIVE_SLEEP_MAX] 内
+ */
+int selectSleepStep(float interval)
+{
+  for (int step : ADAPTIVE_SLEEP_STEPS)
+  {
+    if (step >= interval && step >= ADAPTIVE_SLEEP_MIN)
+    {
+      return std::min(step, ADAPTIVE_SLEEP_MAX);
+    }
+  }
+  return ADAPTIVE_SLEEP_MAX;
+}
+
+#if ADAPTIVE_SLEEP
+static const float AWAKE_MS_EWMA_ALPHA  = 0.2f;
+static const float DRAIN_EWMA_ALPHA     = 0.3f;
+static const float MIN_DRAIN_CORRECTION = 0.25f;
+static const float MAX_DRAIN_CORRECTION = 4.0f;
+// 电量百分比分辨率为 1%，间隔过短或变化过小时趋势不可靠
+static const time_t MIN_TREND_INTERVAL  = 24 * 3600; // 秒
+static const float MIN_TREND_PERCENT    = 2.0f;
+// 电量上升超过此值视为已充电或更换电池，重新开始续航计划
+static const float RECHARGE_PERCENT     = 15.0f;
+// 冷启动时电量不低于此值也视为新电池
+static const float FRESH_BATTERY_PERCENT = 90.0f;
+// 天气变化剧烈的判据
+static const float VOLATILE_TEMP_DELTA  = 2.0f; // °C
+static const float VOLATILE_INTERVAL_FACTOR = 0.5f;
+// 早于此时间说明系统时间未设置
+static const time_t MIN_VALID_EPOCH = 1700000000;
+
+// 唤醒时长的平均值，0 表示尚无数据
+static RTC_DATA_ATTR float awakeMsAvg = 0;
+// 趋势测量的起点，refEpoch 为 0 表示无效（冷启动）
+static RTC_DATA_ATTR time_t refEpoch = 0;
+static RTC_DATA_ATTR float refPercent = 0;
+// 自起点以来各次唤醒按模型预测（未修正）的耗电量，睡眠耗电按经过的时间另算
+static RTC_DATA_ATTR float predictedWakeMah = 0;
+// 上次的天气，用于判断变化是否剧烈
+static RTC_DATA_ATTR bool lastWeatherValid = false;
+static RTC_DATA_ATTR float lastTemperature = 0;
+static RTC_DATA_ATTR uint32_t lastWeatherHash = 0;
+
+static float batteryPercent = NAN;
+static bool weatherVolatile = false;
+
+/* 记录本次唤醒测得的电池电压 */
+void observeBatteryVoltage(uint32_t batteryVoltage)
+{
+  batteryPercent = calcBatPercent(batteryVoltage,
+                                  MIN_BATTERY_VOLTAGE, MAX_BATTERY_VOLTAGE);
+}
+
+/* 与上次的天气比较，判断天气是否变化剧烈（天气现象改变、温度变化较大或正在降水）
+ */
+void observeWeatherVolatility(const cma_weather_t &w)
+{
+  uint32_t weatherHash = fnv1a32(w.weather1, sizeof(w.weather1));
+  weatherHash = fnv1a32(w.weather2, sizeof(w.weather2), weatherHash);
+  weatherVolatile = w.precipitation > 0
+                 || (lastWeatherValid
+                  && (weatherHash != lastWeatherHash
+                   || fabsf(w.temperature - lastTemperature)
+                      >= VOLATILE_TEMP_DELTA));
+  lastWeatherValid = true;
+  lastWeatherHash = weatherHash;
+  lastTemperature = w.temperature;
+} // end observeWeatherVolatility
+
+/* 按实际下降与模型预测之比更新修正系数，返回当前的修正系数 */
+static float updateDrainCorrection(Preferences &prefs, time_t now)
+{
+  float correction = prefs.getFloat("drainCorr", 1.0f);
+  if (now - refEpoch < MIN_TREND_INTERVAL)
+  {
+    return correction;
+  }
+  float sleepMah  = (now - refEpoch) / 3600.0f * SLEEP_CURRENT / 1000.0f;
+  float measured  = refPercent - batteryPercent;
+  float predicted = (predictedWakeMah + sleepMah) / BATTERY_CAPACITY * 100.0f;
+  if (predicted > 0
+   && (measured >= MIN_TREND_PERCENT || predicted >= MIN_TREND_PERCENT))
+  {
+    float ratio = std::min(std::max(measured / predicted,
+                                    MIN_DRAIN_CORRECTION),
+                           MAX_DRAIN_CORRECTION);
+    correction += DRAIN_EWMA_ALPHA * (ratio - correction);
+    prefs.putFloat("drainCorr", correction);
+    Serial.printf("耗电修正系数 %.2f（实际 %.1f%%，预测 %.1f%%）\n",
+                  correction, measured, predicted);
+    refEpoch = now;
+    refPercent = batteryPercent;
+    predictedWakeMah = 0;
+  }
+  return correction;
+} // end updateDrainCorrection
+
+/* 根据能耗模型选择下一次的刷新间隔（分钟）
+ *
+ * 电池电量或系统时间未知时返回 SLEEP_DURATION。应在进入深度睡眠前调用，
+ * awakeMs 为本次唤醒至今的时长
+ */
+int chooseSleepInterval(unsigned long awakeMs)
+{
+  awakeMsAvg = awakeMsAvg == 0 ? awakeMs
+             : awakeMsAvg + AWAKE_MS_EWMA_ALPHA * (awakeMs - awakeMsAvg);
+  time_t now = time(NULL);
+  if (std::isnan(batteryPercent) || now < MIN_VALID_EPOCH)
+  {
+    return SLEEP_DURATION;
+  }
+
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, false);
+  time_t planEnd = prefs.getULong64("planEnd", 0);
+  bool recharged = refEpoch == 0 ? batteryPercent >= FRESH_BATTERY_PERCENT
+                                 : batteryPercent >= refPercent
+                                                     + RECHARGE_PERCENT;
+  if (planEnd == 0 || recharged)
+  { // 新的续航计划
+    planEnd = now + TARGET_RUNTIME * 86400LL;
+    prefs.putULong64("planEnd", planEnd);
+    Serial.println("开始新的续航计划");
+  }
+  if (refEpoch == 0 || recharged)
+  {
+    refEpoch = now;
+    refPercent = batteryPercent;
+    predictedWakeMah = 0;
+  }
+  float correction = updateDrainCorrection(prefs, now);
+  prefs.end();
+
+  // 剩余可用电量平均分配到剩余天数
+  float remainingDays = std::max((planEnd - now) / 86400.0f, 1.0f);
+  float lowPercent = calcBatPercent(LOW_BATTERY_VOLTAGE,
+                                    MIN_BATTERY_VOLTAGE, MAX_BATTERY_VOLTAGE);
+  float usableMah = std::max(batteryPercent - lowPercent, 0.0f)
+                    / 100.0f * BATTERY_CAPACITY;
+  float budgetMahPerDay = usableMah / remainingDays / correction;
+
+  float sleepMahPerDay = SLEEP_CURRENT * 24.0f / 1000.0f;
+  float wakeMah = awakeMsAvg / 3.6e6f * AWAKE_CURRENT;
+  int activeMinutes = BED_TIME == WAKE_TIME ? 1440
+                    : (BED_TIME - WAKE_TIME + 24) % 24 * 60;
+  float wakesPerDay = (budgetMahPerDay - sleepMahPerDay) / wakeMah;
+  float interval = wakesPerDay > 0 ? activeMinutes / wakesPerDay
+                                   : ADAPTIVE_SLEEP_MAX;
+  if (weatherVolatile)
+  {
+    interval *= VOLATILE_INTERVAL_FACTOR;
+  }
+
+  int sleepInterval = selectSleepStep(interval);
+
+  // 累计本次唤醒的预测耗电，用于趋势修正
+  predictedWakeMah += awakeMs / 3.6e6f * AWAKE_CURRENT;
+
+  Serial.printf("电量 %.0f%%，剩余 %.0f天，预算 %.2fmAh/天，刷新间隔 %d分钟%s\n",
+                batteryPercent, remainingDays, budgetMahPerDay, sleepInterval,
+                weatherVolatile ? "（天气多变）" : "");
+  return sleepInterval;
+} // end chooseSleepInterval
+
+#else
+
+void observeBatteryVoltage(uint32_t batteryVoltage) {}
+void observeWeatherVolatility(const cma_weather_t &weather) {}
+int chooseSleepInterval(unsigned long awakeMs) { return SLEEP_DURATION; }
+
+#endif
@@ -0,0 +1,329 @@
+/* 外部 RTC（PCF8563/BL8025C）授时与漂移跟踪
+ *
+ * 外部 RTC 写入 UTC 时间后持续走时，此后每次 SNTP 同步只记录它相对 NTP 的偏差，
+ * 不再改写，直到距写入时（漂移参考点）超过 MIN_DRIFT_INTERVAL：此时由累计偏差
+ * 测得一次晶振漂移，再写入当前时间，开始下一个测量窗口。这样即使 SNTP 同步间隔
+ * 远短于 MIN_DRIFT_INTERVAL，漂移也能测出来。
+ *
+ * 之后的唤醒中，若按漂移估计的误差上限不超过 EXT_RTC_MAX_ERROR，且距上次同步
+ * 不足 NTP_RESYNC_INTERVAL 次唤醒，则用扣除偏差与漂移后的外部 RTC 时间设置系统
+ * 时钟，跳过 SNTP。
+ *
+ * 外部 RTC 保存的是 UTC 时间（含上述偏差），时区由 TIMEZONE 决定。旧版固件在其中
+ * 写入的是本地时间，因此升级后、本固件首次写入前（NVS 中尚无 "rtcFormat"）不信任
+ * 它：跳过上述直接使用与漂移测量，SNTP 失败时的回退按本地时间解读。
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <Arduino.h>
+#include <Preferences.h>
+#include <Wire.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "config.h"
+#include "ext_rtc.h"
+
+static const uint8_t PCF8563_REG_CONTROL_2 = 0x01;
+static const uint8_t PCF8563_REG_SECONDS   = 0x02;
+static const uint8_t PCF8563_REG_ALARM_MIN = 0x09; // 之后依次为时、日、星期
+static const uint8_t PCF8563_VL_BIT  = 0x80; // 低电压标志，置位表示计时曾中断
+static const uint8_t PCF8563_AE_BIT  = 0x80; // 闹钟字段禁用位
+static const uint8_t PCF8563_AIE_BIT = 0x02; // 闹钟中断使能
+
+// 尚未测得漂移时假定的漂移上限（普通 32.768kHz 晶振含温漂）
+static const float UNCALIBRATED_DRIFT_PPM = 100.0f;
+// 校准后保留的最小不确定度
+static const float MIN_DRIFT_UNCERTAINTY_PPM = 5.0f;
+// 测量窗口过短时，RTC 的 1 秒分辨率会淹没漂移，不做测量
+static const time_t MIN_DRIFT_INTERVAL = 12 * 3600; // 秒
+static const float DRIFT_EWMA_ALPHA = 0.3f;
+// 偏差超过此值（如有人手动改过 RTC）时放弃本次测量，重新写入
+static const time_t MAX_TRACKED_OFFSET = 300; // 秒
+
+// 本次上电以来最近一次写入外部 RTC 的时间（UTC，漂移参考点），0 表示尚未写入
+static RTC_DATA_ATTR time_t driftRefEpoch = 0;
+// 最近一次 SNTP 同步的时间（UTC）及当时外部 RTC 的偏差（RTC 减 NTP）
+static RTC_DATA_ATTR time_t lastSyncEpoch = 0;
+static RTC_DATA_ATTR int32_t lastSyncOffset = 0;
+static RTC_DATA_ATTR uint16_t wakesSinceSync = 0;
+
+// 外部 RTC 的保存格式（NVS 键 "rtcFormat"），旧版固件未写此键，保存的是本地时间
+static const uint8_t RTC_FORMAT_LOCAL = 0;
+static const uint8_t RTC_FORMAT_UTC   = 1;
+// 本次上电以来读到的保存格式，-1 表示尚未读取
+static RTC_DATA_ATTR int8_t rtcFormat = -1;
+
+/* 从 NVS 读取漂移估计（ppm，正值表示 RTC 走快），未测量时为 NAN */
+static void loadDrift(float &driftPpm, float &uncertaintyPpm)
+{
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, true);
+  driftPpm       = prefs.getFloat("rtcDrift", NAN);
+  uncertaintyPpm = prefs.getFloat("rtcDriftUnc", UNCALIBRATED_DRIFT_PPM);
+  prefs.end();
+}
+
+static void saveDrift(float driftPpm, float uncertaintyPpm)
+{
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, false);
+  prefs.putFloat("rtcDrift", driftPpm);
+  prefs.putFloat("rtcDriftUnc", uncertaintyPpm);
+  prefs.end();
+}
+
+/* 外部 RTC 是否由本固件写入（保存 UTC 时间） */
+static bool extRtcHoldsUtc()
+{
+  if (rtcFormat < 0)
+  {
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, true);
+    rtcFormat = prefs.getUChar("rtcFormat", RTC_FORMAT_LOCAL);
+    prefs.end();
+  }
+  return rtcFormat == RTC_FORMAT_UTC;
+}
+
+static void markExtRtcUtc()
+{
+  if (extRtcHoldsUtc())
+  {
+    return;
+  }
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, false);
+  prefs.putUChar("rtcFormat", RTC_FORMAT_UTC);
+  prefs.end();
+  rtcFormat = RTC_FORMAT_UTC;
+}
+
+static uint8_t toBcd(int v)
+{
+  return ((v / 10) << 4) | (v % 10);
+}
+
+static bool writeRegisters(uint8_t reg, const uint8_t *data, size_t len)
+{
+  Wire.beginTransmission(RTC_ADDRESS);
+  Wire.write(reg);
+  Wire.write(data, len);
+  return Wire.endTransmission() == 0;
+}
+
+/* 读取外部 RTC 的低电压标志
+ *
+ * 时间可信返回true；标志置位（计时曾因掉电中断）或读取失败返回false
+ */
+bool readExtRtcIntegrity()
+{
+  Wire.beginTransmission(RTC_ADDRESS);
+  Wire.write(PCF8563_REG_SECONDS);
+  if (Wire.endTransmission(false) != 0
+   || Wire.requestFrom(RTC_ADDRESS, static_cast<uint8_t>(1)) != 1)
+  {
+    return false;
+  }
+  return !(Wire.read() & PCF8563_VL_BIT);
+} // end readExtRtcIntegrity
+
+/* 将外部 RTC 的日期时间（UTC）转换为 Unix 时间戳
+ */
+time_t extRtcDateToEpoch(const RTC_Date &date)
+{
+  // 公历日期到 1970-01-01 的天数
+  int y = date.year - (date.month <= 2);
+  int era = (y >= 0 ? y : y - 399) / 400;
+  int yoe = y - era * 400;
+  int doy = (153 * (date.month + (date.month > 2 ? -3 : 9)) + 2) / 5
+            + date.day - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  long days = era * 146097L + doe - 719468L;
+  return static_cast<time_t>(days) * 86400
+         + date.hour * 3600 + date.minute * 60 + date.second;
+} // end extRtcDateToEpoch
+
+/* 外部 RTC 的原始读数（UTC），补上读取之后经过的时间 */
+static time_t extRtcRaw(const peripheral_data_t &periph)
+{
+  return extRtcDateToEpoch(periph.rtcTime)
+         + (millis() - periph.rtcReadMs) / 1000;
+}
+
+/* 外部 RTC 当前时间（UTC），扣除上次同步时的偏差并按此后的漂移修正 */
+static time_t extRtcNow(const peripheral_data_t &periph, float driftPpm)
+{
+  time_t now = extRtcRaw(periph);
+  if (lastSyncEpoch != 0)
+  {
+    now -= lastSyncOffset;
+    if (!std::isnan(driftPpm))
+    {
+      now -= lroundf((now - lastSyncEpoch) * driftPpm / 1e6f);
+    }
+  }
+  return now;
+}
+
+/* 外部 RTC 的读数截断到整秒，取该秒的中点设置系统时钟 */
+static void setSystemTime(time_t epoch)
+{
+  timeval tv = {epoch, 500000};
+  settimeofday(&tv, NULL);
+  setenv("TZ", TIMEZONE, 1);
+  tzset();
+}
+
+/* 若外部 RTC 的估计误差在 EXT_RTC_MAX_ERROR 以内，则用它设置系统时钟
+ *
+ * 返回true表示已设置，可以跳过 SNTP；否则应进行 SNTP 同步
+ */
+bool syncTimeFromExtRtc(const peripheral_data_t &periph)
+{
+  if (lastSyncEpoch == 0 || !periph.rtcIntegrity
+   || wakesSinceSync >= NTP_RESYNC_INTERVAL || !extRtcHoldsUtc())
+  {
+    return false;
+  }
+
+  float driftPpm, uncertaintyPpm;
+  loadDrift(driftPpm, uncertaintyPpm);
+  if (std::isnan(driftPpm))
+  {
+    uncertaintyPpm = UNCALIBRATED_DRIFT_PPM;
+  }
+  time_t now = extRtcNow(periph, driftPpm);
+  time_t elapsed = now - lastSyncEpoch;
+  if (elapsed < 0)
+  {
+    return false;
+  }
+  // 1 秒为 RTC 分辨率，扣除的偏差本身还有 1 秒的量化误差
+  float maxError = (lastSyncOffset != 0 ? 2.0f : 1.0f)
+                   + uncertaintyPpm * elapsed / 1e6f;
+  if (maxError > EXT_RTC_MAX_ERROR)
+  {
+    return false;
+  }
+
+  setSystemTime(now);
+  ++wakesSinceSync;
+  Serial.printf("使用外部 RTC 时间（误差上限 %.1f秒）\n", maxError);
+  return true;
+} // end syncTimeFromExtRtc
+
+/* 无条件使用外部 RTC 时间设置系统时钟，用于 SNTP 失败时的回退
+ *
+ * 外部 RTC 仍是旧版固件写入的本地时间时，按 TIMEZONE 换算为 UTC
+ */
+void setTimeFromExtRtc(const peripheral_data_t &periph)
+{
+  if (!extRtcHoldsUtc())
+  {
+    setenv("TZ", TIMEZONE, 1);
+    tzset();
+    tm local = {};
+    local.tm_year  = periph.rtcTime.year - 1900;
+    local.tm_mon   = periph.rtcTime.month - 1;
+    local.tm_mday  = periph.rtcTime.day;
+    local.tm_hour  = periph.rtcTime.hour;
+    local.tm_min   = periph.rtcTime.minute;
+    local.tm_sec   = periph.rtcTime.second;
+    local.tm_isdst = -1;
+    setSystemTime(mktime(&local) + (millis() - periph.rtcReadMs) / 1000);
+    return;
+  }
+
+  float driftPpm, uncertaintyPpm;
+  loadDrift(driftPpm, uncertaintyPpm);
+  setSystemTime(extRtcNow(periph, driftPpm));
+} // end setTimeFromExtRtc
+
+/* SNTP 同步成功后调用：记录外部 RTC 的偏差，测量窗口已满时测量漂移并写入
+ * 当前 UTC 时间
+ *
+ * 注意：会访问 I2C 总线，必须在外设任务读取完成之后调用
+ */
+void disciplineExtRtc(PCF8563_Class &rtc, const peripheral_data_t &periph)
+{
+  time_t now = time(NULL);
+  lastSyncEpoch = now;
+  wakesSinceSync = 0;
+
+  time_t offset = extRtcRaw(periph) - now;
+  time_t elapsed = now - driftRefEpoch;
+  bool tracking = driftRefEpoch != 0 && periph.rtcIntegrity
+                  && extRtcHoldsUtc() && elapsed > 0 && std::abs(offset) <= MAX_TRACKED_OFFSET;
+  if (tracking && elapsed < MIN_DRIFT_INTERVAL)
+  { // 测量窗口未满，RTC 继续走时，只记录偏差
+    lastSyncOffset = offset;
+    return;
+  }
+
+  if (tracking)
+  {
+    float measuredPpm = offset * 1e6f / elapsed;
+    // RTC 读数与写入各有约 1 秒的量化误差
+    float quantizationPpm = 1.5e6f / elapsed;
+
+    float driftPpm, uncertaintyPpm;
+    loadDrift(driftPpm, uncertaintyPpm);
+    if (std::isnan(driftPpm))
+    {
+      driftPpm = measuredPpm;
+      uncertaintyPpm = quantizationPpm;
+    }
+    else
+    {
+      uncertaintyPpm = fabsf(measuredPpm - driftPpm);
+      driftPpm += DRIFT_EWMA_ALPHA * (measuredPpm - driftPpm);
+    }
+    uncertaintyPpm = std::max({uncertaintyPpm, quantizationPpm,
+                               MIN_DRIFT_UNCERTAINTY_PPM});
+    saveDrift(driftPpm, uncertaintyPpm);
+    Serial.printf("外部 RTC 漂移 %.1fppm（±%.1fppm）\n",
+                  driftPpm, uncertaintyPpm);
+  }
+
+  tm utc = {};
+  gmtime_r(&now, &utc);
+  rtc.setDateTime(utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                  utc.tm_hour, utc.tm_min, utc.tm_sec);
+  markExtRtcUtc();
+  driftRefEpoch = now;
+  lastSyncOffset = 0;
+} // end disciplineExtRtc
+
+/* 设置外部 RTC 闹钟，在 wakeEpoch（UTC，对齐到分钟）时通过 INT 引脚拉低唤醒
+ *
+ * 闹钟按分、时、日匹配，可覆盖一个月以内的睡眠。成功返回true
+ */
+bool scheduleExtRtcAlarm(time_t wakeEpoch)
+{
+  if (lastSyncEpoch == 0)
+  { // 本次上电后外部 RTC 尚未校准，闹钟时间不可信
+    return false;
+  }
+  // 闹钟按外部 RTC 自己的读数匹配
+  time_t rtcEpoch = wakeEpoch + lastSyncOffset;
+  tm utc = {};
+  gmtime_r(&rtcEpoch, &utc);
+  const uint8_t alarm[4] = {toBcd(utc.tm_min),
+                            toBcd(utc.tm_hour),
+                            toBcd(utc.tm_mday),
+                            PCF8563_AE_BIT}; // 不匹配星期
+  // 同时清除 AF/TF 标志并关闭倒计时中断
+  const uint8_t control2 = PCF8563_AIE_BIT;
+  return writeRegisters(PCF8563_REG_ALARM_MIN, alarm, sizeof(alarm))
+      && writeRegisters(PCF8563_REG_CONTROL_2, &control2, 1);
+} // end scheduleExtRtcAlarm
+
+/* 关闭闹钟中断并清除 AF 标志，释放 INT 引脚
+ */
+void clearExtRtcAlarm()
+{
+  const uint8_t control2 = 0;
+  writeRegisters(PCF8563_REG_CONTROL_2, &control2, 1);
+} // end clearExtRtcAlarm
@@ -0,0 +1,219 @@
+/* gzip/deflate 响应解压流
+ *
+ * 使用 ESP32 ROM 中的 miniz（tinfl）解压，不占用额外的代码空间。解压输出写入
+ * 32KB 的环形字典（TINFL_LZ_DICT_SIZE，deflate 回溯引用的最大距离），写满后从头
+ * 覆盖，因此解压后的响应体大小不受限制。
+ * 压缩数据流本身标识结束位置，读完即停止，不依赖 Content-Length 或连接关闭。
+ */
+#include <algorithm>
+#include <cstring>
+#include <Arduino.h>
+#include <esp32/rom/miniz.h>
+
+#include "config.h"
+#include "inflate_stream.h"
+
+static const size_t INFLATE_INPUT_SIZE  = 512;
+
+static const uint8_t GZIP_FHCRC    = 0x02;
+static const uint8_t GZIP_FEXTRA   = 0x04;
+static const uint8_t GZIP_FNAME    = 0x08;
+static const uint8_t GZIP_FCOMMENT = 0x10;
+static const size_t  GZIP_TRAILER_SIZE = 8; // CRC32 + ISIZE
+
+static tinfl_decompressor inflator;
+static uint8_t inflateIn[INFLATE_INPUT_SIZE];
+// 解压输出即 deflate 的字典，解析器读取的数据也直接从中取出
+static uint8_t inflateDict[TINFL_LZ_DICT_SIZE];
+
+/* 解析 Content-Encoding 响应头 */
+content_encoding_t parseContentEncoding(const String &header)
+{
+  if (header.isEmpty() || header.equalsIgnoreCase("identity"))
+  {
+    return CONTENT_IDENTITY;
+  }
+  if (header.equalsIgnoreCase("gzip") || header.equalsIgnoreCase("x-gzip"))
+  {
+    return CONTENT_GZIP;
+  }
+  if (header.equalsIgnoreCase("deflate"))
+  {
+    return CONTENT_DEFLATE;
+  }
+  return CONTENT_UNSUPPORTED;
+}
+
+InflateStream::InflateStream(Stream &src, content_encoding_t encoding)
+  : _src(src), _encoding(encoding)
+{
+  // 数据由 read() 同步解压得到，底层读取已有超时，无需再等待
+  setTimeout(0);
+}
+
+/* 读取至少 1 个字节（等待至底层流超时），返回读取的字节数 */
+size_t InflateStream::readSome(uint8_t *buf, size_t size)
+{
+  size_t want = std::min(static_cast<size_t>(std::max(_src.available(), 1)),
+                         size);
+  size_t n = _src.readBytes(buf, want);
+  _compressed += n;
+  return n;
+}
+
+/* 跳过 gzip 文件头（RFC 1952 第 2.3 节） */
+bool InflateStream::skipGzipHeader()
+{
+  uint8_t h[10];
+  if (_src.readBytes(h, sizeof(h)) != sizeof(h)
+   || h[0] != 0x1F || h[1] != 0x8B || h[2] != 8)
+  {
+    return false;
+  }
+  _compressed += sizeof(h);
+  uint8_t flags = h[3];
+  uint8_t b[2];
+  if (flags & GZIP_FEXTRA)
+  {
+    if (_src.readBytes(b, 2) != 2)
+    {
+      return false;
+    }
+    for (size_t len = b[0] | (b[1] << 8); len > 0; --len)
+    {
+      if (_src.readBytes(b, 1) != 1)
+      {
+        return false;
+      }
+    }
+  }
+  for (uint8_t field : {GZIP_FNAME, GZIP_FCOMMENT})
+  {
+    if (flags & field)
+    { // 以 '\0' 结尾的字符串
+      do
+      {
+        if (_src.readBytes(b, 1) != 1)
+        {
+          return false;
+        }
+      } while (b[0] != 0);
+    }
+  }
+  if ((flags & GZIP_FHCRC) && _src.readBytes(b, 2) != 2)
+  {
+    return false;
+  }
+  return true;
+}
+
+/* 开始解压，压缩格式无效时返回false */
+bool InflateStream::begin()
+{
+  tinfl_init(&inflator);
+  _flags = TINFL_FLAG_HAS_MORE_INPUT;
+  if (_encoding == CONTENT_GZIP)
+  {
+    return skipGzipHeader();
+  }
+  if (_encoding != CONTENT_DEFLATE)
+  {
+    return false;
+  }
+  // HTTP 的 deflate 应为 zlib 封装，但也有服务器发送原始 deflate
+  _inLen = readSome(inflateIn, 2);
+  if (_inLen == 2 && (inflateIn[0] & 0x0F) == 8
+   && ((inflateIn[0] << 8) | inflateIn[1]) % 31 == 0)
+  {
+    _flags |= TINFL_FLAG_PARSE_ZLIB_HEADER;
+  }
+  return _inLen > 0;
+}
+
+/* gzip 数据结束后读取文件尾，使连接可复用于下一次请求，并校验解压长度 */
+void InflateStream::finishGzip()
+{
+  uint8_t trailer[GZIP_TRAILER_SIZE];
+  size_t have = std::min(_inLen - _inPos, GZIP_TRAILER_SIZE);
+  memcpy(trailer, inflateIn + _inPos, have);
+  if (have < GZIP_TRAILER_SIZE)
+  {
+    have += _src.readBytes(trailer + have, GZIP_TRAILER_SIZE - have);
+  }
+  uint32_t isize = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16)
+                   | (static_cast<uint32_t>(trailer[7]) << 24);
+  if (have != GZIP_TRAILER_SIZE || isize != _total)
+  {
+    _failed = true;
+  }
+}
+
+/* 解压一步，返回是否仍可能产生输出 */
+bool InflateStream::pump()
+{
+  if (_inPos == _inLen)
+  {
+    _inPos = 0;
+    _inLen = readSome(inflateIn, sizeof(inflateIn));
+    if (_inLen == 0)
+    { // 超时或连接断开，响应不完整
+      _failed = true;
+      return false;
+    }
+  }
+
+  if (_outLen == sizeof(inflateDict))
+  { // 字典已写满，从头覆盖（此前的输出已被读取）
+    _outPos = _outLen = 0;
+  }
+  size_t inBytes  = _inLen - _inPos;
+  size_t outBytes = sizeof(inflateDict) - _outLen;
+  tinfl_status status = tinfl_decompress(&inflator, inflateIn + _inPos,
+                                         &inBytes, inflateDict,
+                                         inflateDict + _outLen, &outBytes,
+                                         _flags);
+  _inPos  += inBytes;
+  _outLen += outBytes;
+  _total  += outBytes;
+  if (status == TINFL_STATUS_DONE)
+  {
+    _done = true;
+    if (_encoding == CONTENT_GZIP)
+    {
+      finishGzip();
+    }
+#if DEBUG_LEVEL >= 1
+    Serial.printf("解压 %u → %u字节\n", _compressed, _total);
+#endif
+  }
+  else if (status < 0)
+  {
+    _failed = true;
+  }
+  return !_done && !_failed;
+}
+
+/* 确保有未读的解压数据，没有更多数据时返回false */
+bool InflateStream::fill()
+{
+  while (_outPos == _outLen && pump())
+  {
+  }
+  return _outPos < _outLen;
+}
+
+int InflateStream::available()
+{
+  fill();
+  return _outLen - _outPos;
+}
+
+int InflateStream::read()
+{
+  return fill() ? inflateDict[_outPos++] : -1;
+}
+
+int InflateStream::peek()
+{
+  return fill() ? inflateDict[_outPos] : -1;
+}
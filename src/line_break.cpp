@@ -0,0 +1,157 @@
+/* 按像素宽度断行（支持中日韩文字）
+ *
+ * 单次遍历 UTF-8 字符，逐字符累加字形步进宽度，记录最近的断行机会，超出宽度时
+ * 在该处断开（贪心算法），时间与文本长度成正比，不分配内存。字符的解码与测量
+ * 相同（nextTextChar()，不是合法 UTF-8 的字节按 Latin-1 处理），断行类别与宽度一致。
+ *
+ * 断行机会：空格之后（行尾空格不计宽度、会被去掉）、连字符之后、中日韩文字之前
+ * 与之后。遵循基本的避头尾规则：闭合标点（，。）」等）不出现在行首，开括号
+ * （（「《等）不出现在行尾。一个词超过整行宽度时在字符之间强制断开。
+ */
+#include <Arduino.h>
+
+#include "line_break.h"
+#include "text_metrics.h"
+
+/* 中日韩文字与全角符号 */
+static bool isCJK(uint32_t cp)
+{
+  return (cp >= 0x2E80 && cp <= 0x9FFF)   // 部首、标点、假名、汉字等
+      || (cp >= 0xAC00 && cp <= 0xD7AF)   // 谚文音节
+      || (cp >= 0xF900 && cp <= 0xFAFF)   // 兼容汉字
+      || (cp >= 0xFF00 && cp <= 0xFFEF);  // 全角形式
+}
+
+/* 不能出现在行首的字符 */
+static bool noBreakBefore(uint32_t cp)
+{
+  switch (cp)
+  {
+    case ',': case '.': case ';': case ':': case '?': case '!':
+    case ')': case ']': case '}': case '%':
+    case U'，': case U'。': case U'、': case U'；': case U'：':
+    case U'？': case U'！': case U'）': case U'」': case U'』':
+    case U'】': case U'》': case U'〉': case U'”': case U'’':
+    case U'…': case U'％': case U'°': case U'℃':
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* 不能出现在行尾的字符 */
+static bool noBreakAfter(uint32_t cp)
+{
+  switch (cp)
+  {
+    case '(': case '[': case '{':
+    case U'（': case U'「': case U'『': case U'【': case U'《':
+    case U'〈': case U'“': case U'‘':
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* a 与 b 两个相邻字符之间能否断行 */
+static bool canBreakBetween(uint32_t a, uint32_t b)
+{
+  if (b == ' ')
+  {
+    return false;
+  }
+  if (a == ' ')
+  {
+    return true;
+  }
+  if (noBreakBefore(b) || noBreakAfter(a))
+  {
+    return false;
+  }
+  return a == '-' || isCJK(a) || isCJK(b);
+}
+
+/* 从 text 开始取出不超过 maxWidth 像素的一行
+ *
+ * 遇到 '\n' 时结束本行。每行至少包含一个字符，因此总能前进
+ */
+text_line_t breakLine(const GFXfont *font, const char *text,
+                      uint16_t maxWidth)
+{
+  const char *p = text;
+  const char *end = NULL;        // 本行结尾
+  const char *next = NULL;       // 下一行开头
+  const char *breakAt = NULL;    // 最近的断行机会
+  uint32_t prev = 0;
+  uint16_t width = 0;
+  while (*p)
+  {
+    const char *cpStart = p;
+    uint32_t cp = nextTextChar(p);
+    if (cp == '\n')
+    {
+      end = cpStart;
+      next = p;
+      break;
+    }
+    if (prev != 0 && canBreakBetween(prev, cp))
+    {
+      breakAt = cpStart;
+    }
+    uint16_t advance = measureAdvance(font, cpStart, p - cpStart);
+    // 空格可以悬挂在行尾，不会导致断行
+    if (cp != ' ' && width + advance > maxWidth && cpStart != text)
+    {
+      end = next = breakAt != NULL ? breakAt : cpStart;
+      break;
+    }
+    width += advance;
+    prev = cp;
+  }
+  if (end == NULL)
+  {
+    end = next = p;
+  }
+
+  while (end > text && end[-1] == ' ')
+  {
+    --end;
+  }
+  while (*next == ' ')
+  {
+    ++next;
+  }
+  return {static_cast<size_t>(end - text), next};
+} // end breakLine
+
+/* 截取 text 中能与省略号（宽 ellipsisWidth）一起放入 maxWidth 的最长前缀
+ *
+ * 按字符截断，去掉结尾的空格，返回前缀的字节数
+ */
+size_t fitWithEllipsis(const GFXfont *font, const char *text,
+                       uint16_t maxWidth, uint16_t ellipsisWidth)
+{
+  const char *p = text;
+  const char *fit = text;
+  uint16_t width = ellipsisWidth;
+  while (*p)
+  {
+    const char *cpStart = p;
+    uint32_t cp = nextTextChar(p);
+    if (cp == '\n')
+    {
+      break;
+    }
+    width += measureAdvance(font, cpStart, p - cpStart);
+    if (width > maxWidth)
+    {
+      break;
+    }
+    fit = p;
+  }
+  while (fit > text && fit[-1] == ' ')
+  {
+    --fit;
+  }
+  return fit - text;
+} // end fitWithEllipsis
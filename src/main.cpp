@@ -12,7 +12,6 @@
  */
 
 #include <Arduino.h>
-#include <Adafruit_SHT31.h>
 #include <Adafruit_Sensor.h>
 #include <Wire.h>
 #include <pcf8563.h>
@@ -25,22 +24,32 @@
 #include "client_utils.h"
 #include "config.h"
 #include "display_utils.h"
+#include "energy_model.h"
+#include "ext_rtc.h"
 #include "icons/icons_196x196.h"
 #include "renderer.h"
-#if defined(USE_HTTPS_WITH_CERT_VERIF) || defined(USE_HTTPS_WITH_CERT_VERIF)
-  #include <WiFiClientSecure.h>
+#include "sleep_drift.h"
+#include "wake_pipeline.h"
+#include "wake_profiler.h"
+#if defined(USE_HTTPS_NO_CERT_VERIF) || defined(USE_HTTPS_WITH_CERT_VERIF)
+  #include "tls_session.h"
 #endif
 #ifdef USE_HTTPS_WITH_CERT_VERIF
   #include "cert.h"
 #endif
 
 // 太大，无法在栈上分配
-static cma_weather_t weather_data;
+static cma_weather_t weather_data[CMA_MAX_LOCATIONS];
+static int weather_status[CMA_MAX_LOCATIONS];
 // 使用 lewisxhe/PCF8563_Library 驱动 BL8025C 实时时钟
 static PCF8563_Class rtc; // 外部 RTC
 
 Preferences prefs;
 
+#if WAKE_FROM_EXT_RTC
+// 外部 RTC 闹钟未能唤醒时，内部定时器在预定时间之后多久作为后备唤醒
+static const uint64_t EXT_RTC_BACKSTOP_SECONDS = 300;
+#endif
 
 /* 让 esp32 进入超低功耗深度睡眠（<11μA）。
  * 唤醒时间对齐到分钟。睡眠时间在 config.cpp 中定义。
@@ -53,7 +62,7 @@ void beginDeepSleep(unsigned long startTime, tm *timeInfo)
   }
 
   // 为简化睡眠时间计算，当前由 timeInfo 存储的时间将被转换为相对于 WAKE_TIME 的时间。
-  // 这样，如果 SLEEP_DURATION 不是 60 分钟的倍数，可以更容易地对齐，
+  // 这样，如果 sleepInterval 不是 60 分钟的倍数，可以更容易地对齐，
   // 并且可以轻松判断是否需要因睡觉时间而额外睡眠。
   // 例如，当 curHour == 0 时，timeInfo->tm_hour == WAKE_TIME
   int bedtimeHour = INT_MAX;
@@ -62,22 +71,25 @@ void beginDeepSleep(unsigned long startTime, tm *timeInfo)
     bedtimeHour = (BED_TIME - WAKE_TIME + 24) % 24;
   }
 
+  // 刷新间隔由能耗模型决定（未启用 ADAPTIVE_SLEEP 时为 SLEEP_DURATION）
+  const int sleepInterval = chooseSleepInterval(millis() - startTime);
+
   // 时间相对于唤醒时间
   int curHour = (timeInfo->tm_hour - WAKE_TIME + 24) % 24;
   const int curMinute = curHour * 60 + timeInfo->tm_min;
   const int curSecond = curHour * 3600
                       + timeInfo->tm_min * 60
                       + timeInfo->tm_sec;
-  const int desiredSleepSeconds = SLEEP_DURATION * 60;
-  const int offsetMinutes = curMinute % SLEEP_DURATION;
+  const int desiredSleepSeconds = sleepInterval * 60;
+  const int offsetMinutes = curMinute % sleepInterval;
   const int offsetSeconds = curSecond % desiredSleepSeconds;
 
-  // 唤醒时间对齐到 SLEEP_DURATION 的最近倍数
-  int sleepMinutes = SLEEP_DURATION - offsetMinutes;
+  // 唤醒时间对齐到 sleepInterval 的最近倍数
+  int sleepMinutes = sleepInterval - offsetMinutes;
   if (desiredSleepSeconds - offsetSeconds < 120
    || offsetSeconds / (float)desiredSleepSeconds > 0.95f)
-  { // 如果睡眠时间少于 2 分钟或少于 SLEEP_DURATION 的 5%，则跳到下一个对齐点
-    sleepMinutes += SLEEP_DURATION;
+  { // 如果睡眠时间少于 2 分钟或少于 sleepInterval 的 5%，则跳到下一个对齐点
+    sleepMinutes += sleepInterval;
   }
 
   // 预计唤醒时间，如果落在睡眠区间则需要调整 sleepDuration
@@ -95,15 +107,30 @@ void beginDeepSleep(unsigned long startTime, tm *timeInfo)
                     - (timeInfo->tm_min * 60ULL + timeInfo->tm_sec);
   }
 
-  // 增加额外延迟以补偿部分 esp32 RTC 过快的问题
-  sleepDuration += 3ULL;
-  sleepDuration *= 1.0015f;
+  // 按本机测得的 RTC 定时器速率换算定时时长，补偿部分 esp32 RTC 过快的问题
+  uint64_t timerDuration = calibrateSleepDuration(sleepDuration);
+
+#if WAKE_FROM_EXT_RTC
+  // 由外部 RTC 闹钟在对齐的分钟准时唤醒，内部定时器仅作后备
+  time_t wakeEpoch = (time(NULL) + sleepDuration + 30) / 60 * 60;
+  if (scheduleExtRtcAlarm(wakeEpoch))
+  {
+    esp_sleep_enable_ext1_wakeup(1ULL << PIN_RTC_INT, ESP_EXT1_WAKEUP_ALL_LOW);
+    // INT 使用外部上拉，睡眠期间可关闭 RTC 外设电源域
+    // （局部刷新模式下需保持 PIN_EPD_PWR 的电平，不能关闭）
+#if !PARTIAL_REFRESH
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_OFF);
+#endif
+    timerDuration += EXT_RTC_BACKSTOP_SECONDS;
+  }
+#endif
 
 #if DEBUG_LEVEL >= 1
   printHeapUsage();
 #endif
 
-  esp_sleep_enable_timer_wakeup(sleepDuration * 1000000ULL);
+  profilerCommit(millis() - startTime);
+  esp_sleep_enable_timer_wakeup(timerDuration * 1000000ULL);
   Serial.print(TXT_AWAKE_FOR);
   Serial.println(" "  + String((millis() - startTime) / 1000.0, 3) + "秒");
   Serial.print(TXT_ENTERING_DEEP_SLEEP_FOR);
@@ -121,6 +148,9 @@ void setup()
   // 初始化 I2C 与外部实时时钟
   Wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
   rtc.begin();
+#if WAKE_FROM_EXT_RTC
+  clearExtRtcAlarm(); // 释放 INT 引脚，避免再次唤醒
+#endif
 
 #if DEBUG_LEVEL >= 1
   printHeapUsage();
@@ -132,9 +162,12 @@ void setup()
   prefs.begin(NVS_NAMESPACE, false);
 
 #if BATTERY_MONITORING
+  profilerStart(PROF_BATTERY_ADC);
   uint32_t batteryVoltage = readBatteryVoltage();
+  profilerStop(PROF_BATTERY_ADC);
   Serial.print(TXT_BATTERY_VOLTAGE);
   Serial.println("：" + String(batteryVoltage) + "毫伏");
+  observeBatteryVoltage(batteryVoltage);
 
 
   // 当电池电量低时，应该刷新显示，但只在首次检测到低电压时刷新。
@@ -179,6 +212,7 @@ void setup()
       Serial.print(TXT_ENTERING_DEEP_SLEEP_FOR);
       Serial.println(" " + String(LOW_BATTERY_SLEEP_INTERVAL) + "分钟");
     }
+    profilerCommit(millis() - startTime);
     esp_deep_sleep_start();
   }
   // 电池恢复正常，重置非易失性存储变量
@@ -198,12 +232,17 @@ void setup()
   tm timeInfo = {};
 
   // START WIFI
+  // WiFi 关联期间，外设任务在另一核心上并行读取 SHT30、外部 RTC 并初始化墨水屏
   int wifiRSSI = 0; // “接收信号强度指示器"
-  wl_status_t wifiStatus = startWiFi(wifiRSSI);
+  profilerStart(PROF_WIFI_CONNECT);
+  beginWiFi();
+  startPeripheralTask(rtc);
+  wl_status_t wifiStatus = waitForWiFi(wifiRSSI);
+  profilerStop(PROF_WIFI_CONNECT);
   if (wifiStatus != WL_CONNECTED)
   { // WiFi 连接失败
     killWiFi();
-    initDisplay();
+    waitForDisplay();
     if (wifiStatus == WL_NO_SSID_AVAIL)
     {
       Serial.println(TXT_NETWORK_NOT_AVAILABLE);
@@ -225,38 +264,48 @@ void setup()
   }
 
   // 时间同步
-  configTzTime(TIMEZONE, NTP_SERVER_1, NTP_SERVER_2);
-  bool timeConfigured = waitForSNTPSync(&timeInfo);
+  // 外部 RTC 的估计误差足够小时直接使用它，否则进行 SNTP 同步并校准外部 RTC
+  const peripheral_data_t &periph = waitForPeripherals();
+  bool timeConfigured = syncTimeFromExtRtc(periph)
+                        && printLocalTime(&timeInfo);
+  if (!timeConfigured)
+  {
+    profilerStart(PROF_SNTP_SYNC);
+    timeConfigured = waitForSNTPSync(&timeInfo);
+    profilerStop(PROF_SNTP_SYNC);
+    if (timeConfigured)
+    {
+      disciplineExtRtc(rtc, periph);
+      // 只用 NTP 时间校准睡眠定时器：外部 RTC 只有 1 秒分辨率，其截断误差
+      // 会被当作定时器漂移
+      observeSleepDrift();
+    }
+  }
   if (!timeConfigured)
   {
     Serial.println(TXT_TIME_SYNCHRONIZATION_FAILED);
     // 使用外部 RTC 时间作为回退
-    auto now = rtc.getDateTime();
-    timeInfo.tm_year = now.year - 1900;
-    timeInfo.tm_mon  = now.month - 1;
-    timeInfo.tm_mday = now.day;
-    timeInfo.tm_hour = now.hour;
-    timeInfo.tm_min  = now.minute;
-    timeInfo.tm_sec  = now.second;
+    setTimeFromExtRtc(periph);
+    getLocalTime(&timeInfo, 0);
   }
 
   // API 请求
 #ifdef USE_HTTP
   WiFiClient client;
 #elif defined(USE_HTTPS_NO_CERT_VERIF)
-  WiFiClientSecure client;
+  ResumableClientSecure client;
   client.setInsecure();
 #elif defined(USE_HTTPS_WITH_CERT_VERIF)
-  WiFiClientSecure client;
+  ResumableClientSecure client;
   client.setCACert(cert_Sectigo_RSA_Domain_Validation_Secure_Server_CA);
 #endif
-  int rxStatus = getCMAweather(client, weather_data);
+  int rxStatus = getCMAweather(client, weather_data, weather_status);
   if (rxStatus != HTTP_CODE_OK)
     {
       killWiFi();
       statusStr = "中国气象台 API";
       tmpStr = String(rxStatus, DEC) + "：" + getHttpResponsePhrase(rxStatus);
-    initDisplay();
+    waitForDisplay();
     do
     {
       drawError(wi_cloud_down_196x196, statusStr, tmpStr);
@@ -265,35 +314,18 @@ void setup()
     beginDeepSleep(startTime, &timeInfo);
   }
     killWiFi();  // WiFi 不再需要
+  observeWeatherVolatility(weather_data[0]);
 
-  // 读取室内温湿度，使用 SHT30 传感器
-  float inTemp     = NAN;
-  float inHumidity = NAN;
-  Serial.print(String(TXT_READING_FROM) + " SHT30... ");
-  TwoWire I2C_sht = TwoWire(0);
-  Adafruit_SHT31 sht30 = Adafruit_SHT31();
-
-  I2C_sht.begin(PIN_I2C_SDA, PIN_I2C_SCL, 100000); // 100kHz
-  if (sht30.begin(SHT30_ADDRESS))
+  // 室内温湿度，由外设任务通过 SHT30 传感器读取
+  float inTemp     = periph.inTemp;
+  float inHumidity = periph.inHumidity;
+  if (!periph.sht30Found)
   {
-    inTemp     = sht30.readTemperature(); // 摄氏度
-    inHumidity = sht30.readHumidity();    // %
-
-    // 检查 SHT30 读数是否有效
-    if (std::isnan(inTemp) || std::isnan(inHumidity))
-    {
-      statusStr = "SHT30 " + String(TXT_READ_FAILED);
-      Serial.println(statusStr);
-    }
-    else
-    {
-      Serial.println(TXT_SUCCESS);
-    }
+    statusStr = "SHT30 " + String(TXT_NOT_FOUND); // 检查接线
   }
-  else
+  else if (std::isnan(inTemp) || std::isnan(inHumidity))
   {
-    statusStr = "SHT30 " + String(TXT_NOT_FOUND); // 检查接线
-    Serial.println(statusStr);
+    statusStr = "SHT30 " + String(TXT_READ_FAILED);
   }
 
   String refreshTimeStr;
@@ -301,15 +333,62 @@ void setup()
   String dateStr;
   getDateStr(dateStr, &timeInfo);
 
-  // 全屏刷新渲染
-  initDisplay();
-  do
+  // 显示内容与上次刷新相同时跳过刷新（面板本身保持原有画面）
+  uint32_t frameHash = hashFrameContent(weather_data, weather_status,
+                                        CMA_LOCATION_COUNT,
+                                        inTemp, inHumidity,
+                                        CITY_STRING, dateStr, statusStr,
+                                        wifiRSSI, batteryVoltage);
+  waitForDisplay();
+  if (skipFrameRefresh(frameHash))
   {
-    drawCurrentWeather(weather_data, inTemp, inHumidity);
+    Serial.println("显示内容未变化，跳过刷新");
+  }
+  else
+  {
+#if PARTIAL_REFRESH
+    // 整帧绘制到缓冲区，只把内容变化的区域推送到面板
+    profilerStart(PROF_RENDER);
+    drawCurrentWeather(weather_data[0], inTemp, inHumidity);
+    drawLocationTiles(weather_data, weather_status, CMA_LOCATION_COUNT);
     drawLocationDate(CITY_STRING, dateStr);
     drawStatusBar(statusStr, refreshTimeStr, wifiRSSI, batteryVoltage);
-  } while (display.nextPage());
+    profilerStop(PROF_RENDER);
+    profilerStart(PROF_EPD_REFRESH);
+    refreshChangedRegions();
+    profilerStop(PROF_EPD_REFRESH);
+#else
+    // 全屏刷新渲染
+    // 绘制函数只运行一次，生成的图元记录在显示列表中，每页只重放与该页相交的部分
+    profilerStart(PROF_RENDER);
+    beginDisplayList();
+    drawCurrentWeather(weather_data[0], inTemp, inHumidity);
+    drawLocationTiles(weather_data, weather_status, CMA_LOCATION_COUNT);
+    drawLocationDate(CITY_STRING, dateStr);
+    drawStatusBar(statusStr, refreshTimeStr, wifiRSSI, batteryVoltage);
+    endDisplayList();
+    profilerStop(PROF_RENDER);
+    bool morePages;
+    uint16_t page = 0;
+    do
+    {
+      profilerStart(PROF_RENDER);
+      replayDisplayList(page++);
+      profilerStop(PROF_RENDER);
+      // 最后一页的 nextPage() 会触发面板刷新并等待 BUSY
+      profilerStart(PROF_EPD_REFRESH);
+      morePages = display.nextPage();
+      profilerStop(PROF_EPD_REFRESH);
+    } while (morePages);
+#endif
+    recordFrameRefresh(frameHash);
+#if DEBUG_LEVEL >= 1
+    printRenderStats();
+#endif
+  }
+  profilerStart(PROF_EPD_POWER_OFF);
   powerOffDisplay();
+  profilerStop(PROF_EPD_POWER_OFF);
 
   // 深度睡眠
   beginDeepSleep(startTime, &timeInfo);
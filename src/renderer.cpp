@@ -1,12 +1,27 @@
 /* 简化渲染器：根据中国气象台数据在墨水屏上绘制内容 */
+#include <algorithm>
+#if PARTIAL_REFRESH
+  #include <driver/gpio.h>
+  #include <esp_system.h>
+#endif
+#include <HTTPClient.h>
 #include "_locale.h"
 #include "_strftime.h"
 #include "renderer.h"
 #include "display_utils.h"
+#include "line_break.h"
+#include "text_metrics.h"
 #include "config.h"
 
 // 字体
 #include FONT_HEADER
+#ifdef CJK_FONT_HEADER
+  #include CJK_FONT_HEADER
+  #if !(defined(CJK_FONT_6pt) && defined(CJK_FONT_12pt) \
+        && defined(CJK_FONT_16pt) && defined(CJK_FONT_26pt))
+    #error Invalid configuration. CJK_FONT_HEADER must provide 6pt, 12pt, 16pt and 26pt fonts.
+  #endif
+#endif
 // 图标
 #include "icons/icons_16x16.h"
 #include "icons/icons_24x24.h"
@@ -47,88 +62,447 @@
                PIN_EPD_BUSY));
 #endif
 
+// 上次刷新到面板上的内容哈希（0 表示未知或显示的是错误界面），以及之后连续跳过的次数
+static RTC_DATA_ATTR uint32_t lastFrameHash = 0;
+static RTC_DATA_ATTR uint16_t skippedRefreshes = 0;
+
+// 屏幕上的矩形区域
+typedef struct {
+  int16_t x, y, w, h;
+} rect_t;
+
+// 每个绘制函数负责屏幕上的一个区域
+typedef enum {
+  REGION_CURRENT_WEATHER,
+  REGION_LOCATION_DATE,
+  REGION_STATUS_BAR,
+  REGION_LOCATION_TILES,
+  REGION_COUNT
+} region_t;
+
+typedef struct {
+  rect_t   rect; // 绘制内容的外接矩形，w == 0 表示未绘制任何内容
+  uint32_t hash; // 绘制内容（文字、图标及其位置、颜色）的哈希，0 表示未知
+} region_state_t;
+
+// 本次唤醒绘制到缓冲区的各区域，以及正在绘制的区域
+static region_state_t drawnRegions[REGION_COUNT];
+static region_state_t drawingRegion;
+
+#if DEBUG_LEVEL >= 1
+// 各区域的绘制统计（分页绘制时累加所有页），用于比较渲染路径的优化效果。
+// 区域哈希由绘制调用的参数（位置、文字、图标、颜色）计算，不是像素内容：输入相同
+// 而哈希改变说明绘制调用发生了变化，但字体或 GFX 库的栅格化变化不会反映在其中。
+typedef struct {
+  uint16_t      prims;  // 绘制的文字与图标数
+  uint16_t      bounds; // 文本测量次数（含缓存命中）
+  uint32_t      glyphs; // 绘制的文字字节数
+  unsigned long us;     // 耗时
+} region_stats_t;
+
+static const char *const REGION_NAMES[REGION_COUNT] = {
+  "current", "location", "status", "tiles"
+};
+static region_stats_t regionStats[REGION_COUNT];
+static region_stats_t drawingStats;
+static unsigned long drawingStart;
+// 显示列表重放统计（见 replayDisplayList()）
+static uint16_t replayPages  = 0;
+static uint16_t replayPrims  = 0;
+static unsigned long replayUs = 0;
+  #define RENDER_STAT(field, n) (drawingStats.field += (n))
+#else
+  #define RENDER_STAT(field, n)
+#endif
+
+#if PARTIAL_REFRESH
+// 面板上当前显示的各区域
+static RTC_DATA_ATTR region_state_t panelRegions[REGION_COUNT];
+// 面板控制器在深度睡眠期间是否保持供电（显存中仍保存着 panelRegions 对应的画面）
+static RTC_DATA_ATTR bool panelRetained = false;
+// 上次全屏刷新之后的局部刷新次数
+static RTC_DATA_ATTR uint16_t partialRefreshes = 0;
+#endif
+
+static rect_t unionRect(const rect_t &a, const rect_t &b)
+{
+  if (a.w <= 0 || a.h <= 0) return b;
+  if (b.w <= 0 || b.h <= 0) return a;
+  int16_t x0 = std::min(a.x, b.x);
+  int16_t y0 = std::min(a.y, b.y);
+  int16_t x1 = std::max(a.x + a.w, b.x + b.w);
+  int16_t y1 = std::max(a.y + a.h, b.y + b.h);
+  return {x0, y0, static_cast<int16_t>(x1 - x0),
+                  static_cast<int16_t>(y1 - y0)};
+}
+
+/* 开始记录一个区域的绘制内容 */
+static void beginRegion()
+{
+  drawingRegion = {};
+  drawingRegion.hash = fnv1a32(NULL, 0);
+#if DEBUG_LEVEL >= 1
+  drawingStats = {};
+  drawingStart = micros();
+#endif
+}
+
+/* 记录一次绘制：扩展区域范围，并把内容计入区域哈希 */
+static void markDrawn(int16_t x, int16_t y, int16_t w, int16_t h,
+                      const void *data, size_t len, uint16_t color)
+{
+  RENDER_STAT(prims, 1);
+  const rect_t r = {x, y, w, h};
+  drawingRegion.rect = unionRect(drawingRegion.rect, r);
+  drawingRegion.hash = fnv1a32(&r, sizeof(r), drawingRegion.hash);
+  drawingRegion.hash = fnv1a32(&color, sizeof(color), drawingRegion.hash);
+  drawingRegion.hash = fnv1a32(data, len, drawingRegion.hash);
+}
+
+/* 结束记录，保存该区域本次的绘制结果 */
+static void endRegion(region_t region)
+{
+  if (drawingRegion.hash == 0)
+  {
+    drawingRegion.hash = 1;
+  }
+  drawnRegions[region] = drawingRegion;
+#if DEBUG_LEVEL >= 1
+  region_stats_t &stats = regionStats[region];
+  stats.prims  += drawingStats.prims;
+  stats.bounds += drawingStats.bounds;
+  stats.glyphs += drawingStats.glyphs;
+  stats.us     += micros() - drawingStart;
+#endif
+}
+
+#if DEBUG_LEVEL >= 1
+/* 通过串口输出本次唤醒各区域的绘制统计，每个区域一行 */
+void printRenderStats()
+{
+  for (int i = 0; i < REGION_COUNT; ++i)
+  {
+    const region_stats_t &stats = regionStats[i];
+    const rect_t &r = drawnRegions[i].rect;
+    Serial.printf("RENDER region=%s us=%lu prims=%u bounds=%u glyphs=%u "
+                  "hash=%08x rect=%d,%d,%d,%d\n",
+                  REGION_NAMES[i], stats.us, stats.prims, stats.bounds,
+                  static_cast<unsigned>(stats.glyphs),
+                  static_cast<unsigned>(drawnRegions[i].hash),
+                  r.x, r.y, r.w, r.h);
+  }
+  Serial.printf("RENDER replay pages=%u prims=%u us=%lu\n",
+                replayPages, replayPrims, replayUs);
+  uint32_t hits, misses;
+  getTextMetricsStats(hits, misses);
+  Serial.printf("RENDER text_cache hits=%u misses=%u\n",
+                static_cast<unsigned>(hits), static_cast<unsigned>(misses));
+}
+#endif
+
+// 当前字体，Adafruit_GFX 不提供读取接口，由 setFont() 记录
+static const GFXfont *currentFont = NULL;
+
+/* 设置字体，绘制函数应使用此函数而非 display.setFont() */
+void setFont(const GFXfont *font)
+{
+  currentFont = font;
+  display.setFont(font);
+}
+
+/* 以当前字体测量字符串，结果按字体与内容缓存 */
+static text_bounds_t measureString(const char *text, size_t len)
+{
+  RENDER_STAT(bounds, 1);
+  return measureText(currentFont, text, len);
+}
+
 /* 计算字符串宽度 */
 uint16_t getStringWidth(const String &text)
 {
-  int16_t x1, y1; uint16_t w, h;
-  display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
-  return w;
+  return measureString(text.c_str(), text.length()).w;
 }
 
 /* 计算字符串高度 */
 uint16_t getStringHeight(const String &text)
 {
-  int16_t x1, y1; uint16_t w, h;
-  display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
-  return h;
+  return measureString(text.c_str(), text.length()).h;
+}
+
+// 显示列表
+//   分页面板（DISP_3C_B 为 2 页，DISP_7C_F 为 4 页）上，绘制函数若每页都运行一遍，
+//   字符串拼接、测量与字形遍历都要重复。beginDisplayList() 之后，绘制函数只把定位
+//   好的图元记录下来（按所在的页分组），之后每页由 replayDisplayList() 只重放与该页
+//   相交的图元。
+static const size_t DISPLAY_LIST_SIZE      = 96;   // 图元数
+static const size_t DISPLAY_LIST_TEXT_SIZE = 3072; // 文字字节数
+
+typedef enum : uint8_t {
+  DL_TEXT,
+  DL_ICON,
+  DL_ROUND_RECT
+} dl_kind_t;
+
+typedef struct {
+  dl_kind_t kind;
+  uint8_t   pages;  // 与之相交的页（位掩码，见 pageBit()）
+  uint16_t  color;
+  int16_t   x, y;   // 文字为光标（基线起点），其余为左上角
+  int16_t   w, h;   // 图标与边框的尺寸
+  int16_t   radius; // 边框圆角半径
+  union {
+    const GFXfont *font;  // 文字
+    const uint8_t *bitmap; // 图标
+  };
+  uint16_t  textOffset, textLen; // 文字在 dlText 中的位置
+} dl_entry_t;
+
+static dl_entry_t dlEntries[DISPLAY_LIST_SIZE];
+static char dlText[DISPLAY_LIST_TEXT_SIZE];
+static size_t dlCount    = 0;
+static size_t dlTextUsed = 0;
+static bool dlRecording  = false;
+
+/* 页对应的掩码位，第 8 页及之后的页共用最高位 */
+static uint8_t pageBit(int page)
+{
+  return page < 8 ? 1 << page : 0x80;
+}
+
+/* 记录一个图元，top 与 height 为其外接矩形的纵向范围，列表已满时返回false */
+static bool recordEntry(dl_entry_t &e, int16_t top, int16_t height)
+{
+  if (dlCount >= DISPLAY_LIST_SIZE)
+  {
+    log_e("显示列表已满，图元被丢弃");
+    return false;
+  }
+  const int pageH = display.pageHeight();
+  e.pages = 0;
+  if (height > 0)
+  {
+    int first = std::max<int>(top, 0) / pageH;
+    int last  = std::max<int>(top + height - 1, 0) / pageH;
+    for (int page = first; page <= last; ++page)
+    {
+      e.pages |= pageBit(page);
+    }
+  }
+  dlEntries[dlCount++] = e;
+  return true;
+}
+
+/* 开始记录显示列表，之后的绘制只记录不输出 */
+void beginDisplayList()
+{
+  dlCount = 0;
+  dlTextUsed = 0;
+  dlRecording = true;
+}
+
+/* 结束记录 */
+void endDisplayList()
+{
+  dlRecording = false;
+}
+
+/* 以 font 从基线起点 (x, y) 逐字绘制 text[0, len)，display 的字体须已设为 font
+ *
+ * font 中没有的字符从与之配对的中文字体中查找，都没有的字符被跳过
+ */
+static void drawGlyphs(const GFXfont *font, int16_t x, int16_t y,
+                       const char *text, size_t len, uint16_t color)
+{
+  glyph_info_t g;
+  for (const char *p = text, *end = text + len; p < end; )
+  {
+    uint32_t cp = nextTextChar(p);
+    if (cp == 0)
+    {
+      break;
+    }
+    if (!lookupGlyph(font, cp, g))
+    {
+      continue;
+    }
+    if (g.bitmap == NULL)
+    {
+      display.drawChar(x, y, static_cast<unsigned char>(cp),
+                       color, color, 1);
+    }
+    else
+    {
+      display.drawBitmap(x + g.xOffset, y + g.yOffset, g.bitmap,
+                         g.width, g.height, color);
+    }
+    x += g.xAdvance;
+  }
+}
+
+/* 将显示列表中与第 page 页（从 0 开始）相交的图元绘制到当前页的缓冲区 */
+void replayDisplayList(uint16_t page)
+{
+#if DEBUG_LEVEL >= 1
+  unsigned long start = micros();
+  ++replayPages;
+#endif
+  const uint8_t bit = pageBit(page);
+  for (size_t i = 0; i < dlCount; ++i)
+  {
+    const dl_entry_t &e = dlEntries[i];
+    if (!(e.pages & bit))
+    {
+      continue;
+    }
+#if DEBUG_LEVEL >= 1
+    ++replayPrims;
+#endif
+    switch (e.kind)
+    {
+      case DL_TEXT:
+        display.setFont(e.font);
+        drawGlyphs(e.font, e.x, e.y, dlText + e.textOffset, e.textLen,
+                   e.color);
+        break;
+      case DL_ICON:
+        display.drawInvertedBitmap(e.x, e.y, e.bitmap, e.w, e.h, e.color);
+        break;
+      case DL_ROUND_RECT:
+        display.drawRoundRect(e.x, e.y, e.w, e.h, e.radius, e.color);
+        break;
+    }
+  }
+  display.setFont(currentFont);
+#if DEBUG_LEVEL >= 1
+  replayUs += micros() - start;
+#endif
+}
+
+/* 按对齐方式绘制 text[0, len)，无需以 '\0' 结尾 */
+static void drawText(int16_t x, int16_t y, const char *text, size_t len,
+                     alignment_t align, uint16_t color)
+{
+  const text_bounds_t b = measureString(text, len);
+  RENDER_STAT(glyphs, len);
+  int16_t shift = 0;
+  if (align == RIGHT) shift = b.w;
+  if (align == CENTER) shift = b.w / 2;
+  x -= shift;
+  markDrawn(x + b.x1, y + b.y1, b.w, b.h, text, len, color);
+  if (!dlRecording)
+  {
+    drawGlyphs(currentFont, x, y, text, len, color);
+    return;
+  }
+  if (dlTextUsed + len > sizeof(dlText))
+  {
+    log_e("显示列表文字区已满，文字被丢弃");
+    return;
+  }
+  dl_entry_t e = {};
+  e.kind       = DL_TEXT;
+  e.color      = color;
+  e.x          = x;
+  e.y          = y;
+  e.font       = currentFont;
+  e.textOffset = dlTextUsed;
+  e.textLen    = len;
+  if (recordEntry(e, y + b.y1, b.h))
+  {
+    memcpy(dlText + dlTextUsed, text, len);
+    dlTextUsed += len;
+  }
 }
 
 /* 按对齐方式绘制字符串 */
+void drawString(int16_t x, int16_t y, const char *text, alignment_t align,
+                uint16_t color)
+{
+  drawText(x, y, text, strlen(text), align, color);
+}
+
 void drawString(int16_t x, int16_t y, const String &text, alignment_t align,
                 uint16_t color)
 {
-  int16_t x1, y1; uint16_t w, h;
-  display.setTextColor(color);
-  display.getTextBounds(text, x, y, &x1, &y1, &w, &h);
-  if (align == RIGHT) x -= w;
-  if (align == CENTER) x -= w / 2;
-  display.setCursor(x, y);
-  display.print(text);
+  drawString(x, y, text.c_str(), align, color);
 }
 
-/* 多行文本绘制 */
+/* 绘制图标 */
+static void drawIcon(int16_t x, int16_t y, const uint8_t *bitmap,
+                     int16_t w, int16_t h, uint16_t color)
+{
+  markDrawn(x, y, w, h, &bitmap, sizeof(bitmap), color);
+  if (!dlRecording)
+  {
+    display.drawInvertedBitmap(x, y, bitmap, w, h, color);
+    return;
+  }
+  dl_entry_t e = {};
+  e.kind   = DL_ICON;
+  e.color  = color;
+  e.x      = x;
+  e.y      = y;
+  e.w      = w;
+  e.h      = h;
+  e.bitmap = bitmap;
+  recordEntry(e, y, h);
+}
+
+/* 多行文本绘制
+ * 按 max_w 断行（支持中文），超过 max_lines 行时最后一行以 "..." 结尾
+ */
 void drawMultiLnString(int16_t x, int16_t y, const String &text,
                        alignment_t align, uint16_t max_w,
                        uint16_t max_lines, int16_t line_spacing,
                        uint16_t color)
 {
-  uint16_t current = 0; String remain = text;
-  while (current < max_lines && !remain.isEmpty())
+  static const char ELLIPSIS[] = "...";
+  const char *remain = text.c_str();
+  for (uint16_t current = 0; current < max_lines && *remain; ++current)
   {
-    int16_t x1, y1; uint16_t w, h;
-    display.getTextBounds(remain, 0, 0, &x1, &y1, &w, &h);
-    int endIndex = remain.length();
-    String sub = remain; int splitAt = 0; int keep = 0;
-    while (w > max_w && splitAt != -1)
+    const int16_t lineY = y + current * line_spacing;
+    text_line_t line = breakLine(currentFont, remain, max_w);
+    if (current < max_lines - 1 || *line.next == '\0')
     {
-      if (keep) { sub.remove(sub.length() - 1); }
-      splitAt = current < max_lines - 1 ?
-                std::max(sub.lastIndexOf(" "), sub.lastIndexOf("-")) :
-                sub.lastIndexOf(" ");
-      if (splitAt != -1)
-      {
-        endIndex = splitAt;
-        sub = sub.substring(0, endIndex + 1);
-        char last = sub.charAt(endIndex);
-        if (last == ' ') { keep = 0; sub.remove(endIndex); --endIndex; }
-        else if (last == '-') { keep = 1; }
-        if (current == max_lines - 1)
-        {
-          display.getTextBounds(sub + "...", 0, 0, &x1, &y1, &w, &h);
-          if (w <= max_w) sub += "...";
-        }
-        else
-        {
-          display.getTextBounds(sub, 0, 0, &x1, &y1, &w, &h);
-        }
-      }
+      drawText(x, lineY, remain, line.len, align, color);
+      remain = line.next;
+      continue;
     }
-    drawString(x, y + current * line_spacing, sub, align, color);
-    remain = remain.substring(endIndex + 2 - keep);
-    ++current;
+
+    // 最后一行放不下剩余文本，截断并接上省略号，作为整体对齐
+    const uint16_t ellipsisW = measureAdvance(currentFont, ELLIPSIS,
+                                              sizeof(ELLIPSIS) - 1);
+    size_t len = fitWithEllipsis(currentFont, remain, max_w, ellipsisW);
+    const int16_t lineW = measureAdvance(currentFont, remain, len) + ellipsisW;
+    int16_t left = x;
+    if (align == RIGHT) left = x - lineW;
+    if (align == CENTER) left = x - lineW / 2;
+    drawText(left, lineY, remain, len, LEFT, color);
+    drawText(left + lineW - ellipsisW, lineY, ELLIPSIS, sizeof(ELLIPSIS) - 1,
+             LEFT, color);
+    break;
   }
 }
 
 /* 初始化墨水屏 */
 void initDisplay()
 {
+#if PARTIAL_REFRESH
+  // 面板在深度睡眠期间保持了供电时，显存中仍是上一帧，无需初始全屏刷新
+  panelRetained = panelRetained && esp_reset_reason() == ESP_RST_DEEPSLEEP;
+  gpio_hold_dis(static_cast<gpio_num_t>(PIN_EPD_PWR));
+  gpio_hold_dis(static_cast<gpio_num_t>(PIN_EPD_RST));
+  const bool initial = !panelRetained;
+#else
+  const bool initial = true;
+#endif
   pinMode(PIN_EPD_PWR, OUTPUT);
   digitalWrite(PIN_EPD_PWR, HIGH);
 #ifdef DRIVER_WAVESHARE
-  display.init(115200, true, 2, false);
+  display.init(115200, initial, 2, false);
 #endif
 #ifdef DRIVER_DESPI_C02
-  display.init(115200, true, 10, false);
+  display.init(115200, initial, 10, false);
 #endif
   SPI.end();
   SPI.begin(PIN_EPD_SCK, PIN_EPD_MISO, PIN_EPD_MOSI, PIN_EPD_CS);
@@ -136,13 +510,46 @@ void initDisplay()
   display.setTextSize(1);
   display.setTextColor(GxEPD_BLACK);
   display.setTextWrap(false);
+#ifdef CJK_FONT_HEADER
+  registerCjkFont(&FONT_6pt8b,  &CJK_FONT_6pt);
+  registerCjkFont(&FONT_12pt8b, &CJK_FONT_12pt);
+  registerCjkFont(&FONT_16pt8b, &CJK_FONT_16pt);
+  registerCjkFont(&FONT_26pt8b, &CJK_FONT_26pt);
+#endif
   display.setFullWindow();
   display.firstPage();
 }
 
+#if PARTIAL_REFRESH
+/* 面板上的画面是否为已知的正常界面（而非错误界面） */
+static bool panelRegionsKnown()
+{
+  for (int i = 0; i < REGION_COUNT; ++i)
+  {
+    if (panelRegions[i].hash == 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
 /* 关闭墨水屏电源 */
 void powerOffDisplay()
 {
+#if PARTIAL_REFRESH
+  if (panelRegionsKnown())
+  { // 只关闭驱动电压，控制器保持供电以保留显存，作为下次局部刷新的基准
+    display.powerOff();
+    gpio_hold_en(static_cast<gpio_num_t>(PIN_EPD_PWR));
+    gpio_hold_en(static_cast<gpio_num_t>(PIN_EPD_RST));
+    gpio_deep_sleep_hold_en();
+    panelRetained = true;
+    return;
+  }
+  panelRetained = false;
+#endif
   display.hibernate();
   digitalWrite(PIN_EPD_PWR, LOW);
 }
@@ -151,33 +558,125 @@ void powerOffDisplay()
 void drawCurrentWeather(const cma_weather_t &w,
                         float inTemp, float inHumidity)
 {
-  display.setFont(&FONT_26pt8b);
-  drawString(10, 40, w.weather1 + "/" + w.weather2, LEFT);
-  display.setFont(&FONT_16pt8b);
-  drawString(10, 80, String("温度 ") + String(w.temperature,1) + "°C  湿度 " +
-                      String(w.humidity) + "%", LEFT);
-  drawString(10, 110, String("风 ") + w.windDirection + " " +
-                      String(w.windSpeed,1) + "m/s", LEFT);
-  drawString(10, 140, String("降水 ") + String(w.precipitation,1) + "mm", LEFT);
-  drawString(10, 170, String("室内温度 ") + String(inTemp,1) + "°C  室内湿度 " +
-                      String(inHumidity,1) + "%", LEFT);
+  beginRegion();
+  char buf[2 * CMA_TEXT_SHORT + 32];
+  setFont(&FONT_26pt8b);
+  snprintf(buf, sizeof(buf), "%s/%s", w.weather1, w.weather2);
+  drawString(10, 40, buf, LEFT);
+  setFont(&FONT_16pt8b);
+  snprintf(buf, sizeof(buf), "温度 %.1f°C  湿度 %u%%",
+           w.temperature, w.humidity);
+  drawString(10, 80, buf, LEFT);
+  if (w.windScaleLevel != WIND_SCALE_UNKNOWN)
+  {
+    snprintf(buf, sizeof(buf), "风 %s %u级 %.1fm/s",
+             w.windDirection, w.windScaleLevel, w.windSpeed);
+  }
+  else
+  {
+    snprintf(buf, sizeof(buf), "风 %s %.1fm/s", w.windDirection, w.windSpeed);
+  }
+  drawString(10, 110, buf, LEFT);
+  snprintf(buf, sizeof(buf), "降水 %.1fmm", w.precipitation);
+  drawString(10, 140, buf, LEFT);
+  snprintf(buf, sizeof(buf), "室内温度 %.1f°C  室内湿度 %.1f%%",
+           inTemp, inHumidity);
+  drawString(10, 170, buf, LEFT);
+  // 天气图标，位于城市与日期下方
+  drawIcon(DISP_WIDTH - 2 - 96, 60, getWeatherBitmap96(w.weather1Code),
+           96, 96, GxEPD_BLACK);
+  endRegion(REGION_CURRENT_WEATHER);
+}
+
+// 其余地点的卡片所在区域（位于当前天气与状态栏之间）
+static const int16_t TILE_TOP    = 200;
+static const int16_t TILE_HEIGHT = 240;
+static const int16_t TILE_MARGIN = 10;
+
+/* 绘制卡片边框 */
+static void drawTileFrame(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  static const int16_t radius = 8;
+  markDrawn(x, y, w, h, NULL, 0, GxEPD_BLACK);
+  if (!dlRecording)
+  {
+    display.drawRoundRect(x, y, w, h, radius, GxEPD_BLACK);
+    return;
+  }
+  dl_entry_t e = {};
+  e.kind   = DL_ROUND_RECT;
+  e.color  = GxEPD_BLACK;
+  e.x      = x;
+  e.y      = y;
+  e.w      = w;
+  e.h      = h;
+  e.radius = radius;
+  recordEntry(e, y, h);
+}
+
+/* 绘制其余地点的卡片，每个地点一张，横向平分屏幕宽度
+ * status[i] 不是 HTTP_CODE_OK 时只显示名称与错误码
+ */
+void drawLocationTiles(const cma_weather_t w[], const int status[],
+                       size_t count)
+{
+  beginRegion();
+  if (count > 1)
+  {
+    const int16_t tileW = (DISP_WIDTH - TILE_MARGIN) / (count - 1);
+    char buf[2 * CMA_TEXT_SHORT + 32];
+    for (size_t i = 1; i < count; ++i)
+    {
+      const int16_t x = TILE_MARGIN + (i - 1) * tileW;
+      const int16_t y = TILE_TOP;
+      const char *label = CMA_LOCATIONS[i].label;
+      const bool ok = status[i] == HTTP_CODE_OK;
+      drawTileFrame(x, y, tileW - TILE_MARGIN, TILE_HEIGHT);
+      setFont(&FONT_16pt8b);
+      drawString(x + 10, y + 32, *label || !ok ? label : w[i].place, LEFT,
+                 ACCENT_COLOR);
+      setFont(&FONT_12pt8b);
+      if (!ok)
+      {
+        snprintf(buf, sizeof(buf), "获取失败 %d", status[i]);
+        drawString(x + 10, y + 80, buf, LEFT);
+        continue;
+      }
+      drawIcon(x + tileW - TILE_MARGIN - 10 - 48, y + 8,
+               getWeatherBitmap48(w[i].weather1Code), 48, 48, GxEPD_BLACK);
+      drawString(x + 10, y + 80, w[i].weather1, LEFT);
+      snprintf(buf, sizeof(buf), "温度 %.1f°C", w[i].temperature);
+      drawString(x + 10, y + 115, buf, LEFT);
+      snprintf(buf, sizeof(buf), "湿度 %u%%", w[i].humidity);
+      drawString(x + 10, y + 150, buf, LEFT);
+      snprintf(buf, sizeof(buf), "风 %s %.1fm/s",
+               w[i].windDirection, w[i].windSpeed);
+      drawString(x + 10, y + 185, buf, LEFT);
+      snprintf(buf, sizeof(buf), "降水 %.1fmm", w[i].precipitation);
+      drawString(x + 10, y + 220, buf, LEFT);
+    }
+  }
+  endRegion(REGION_LOCATION_TILES);
 }
 
 /* 绘制城市与日期 */
 void drawLocationDate(const String &city, const String &date)
 {
-  display.setFont(&FONT_16pt8b);
+  beginRegion();
+  setFont(&FONT_16pt8b);
   drawString(DISP_WIDTH - 2, 23, city, RIGHT, ACCENT_COLOR);
-  display.setFont(&FONT_12pt8b);
+  setFont(&FONT_12pt8b);
   drawString(DISP_WIDTH - 2, 30 + 4 + 17, date, RIGHT);
+  endRegion(REGION_LOCATION_DATE);
 }
 
 /* 绘制状态栏：刷新时间、WiFi、电池等 */
 void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
                    int rssi, uint32_t batVoltage)
 {
+  beginRegion();
   String dataStr; uint16_t dataColor = GxEPD_BLACK;
-  display.setFont(&FONT_6pt8b);
+  setFont(&FONT_6pt8b);
   int pos = DISP_WIDTH - 2; const int sp = 2;
 #if BATTERY_MONITORING
   uint32_t batPercent = calcBatPercent(batVoltage,
@@ -186,35 +685,40 @@ void drawStatusBar(const String &statusStr, const String &refreshTimeStr,
   dataStr = String(batPercent) + "%";
   drawString(pos, DISP_HEIGHT - 1 - 2, dataStr, RIGHT, dataColor);
   pos -= getStringWidth(dataStr) + 25;
-  display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 17,
-                             getBatBitmap24(batPercent), 24, 24, dataColor);
+  drawIcon(pos, DISP_HEIGHT - 1 - 17,
+           getBatBitmap24(batPercent), 24, 24, dataColor);
   pos -= sp + 9;
 #endif
   dataStr = String(getWiFidesc(rssi));
   drawString(pos, DISP_HEIGHT - 1 - 2, dataStr, RIGHT, dataColor);
   pos -= getStringWidth(dataStr) + 19;
-  display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 13, getWiFiBitmap16(rssi),
-                             16, 16, dataColor);
+  drawIcon(pos, DISP_HEIGHT - 1 - 13, getWiFiBitmap16(rssi),
+           16, 16, dataColor);
   pos -= sp + 8;
   drawString(pos, DISP_HEIGHT - 1 - 2, refreshTimeStr, RIGHT, dataColor);
   pos -= getStringWidth(refreshTimeStr) + 25;
-  display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 21, wi_refresh_32x32,
-                             32, 32, dataColor);
+  drawIcon(pos, DISP_HEIGHT - 1 - 21, wi_refresh_32x32,
+           32, 32, dataColor);
   pos -= sp;
   if (!statusStr.isEmpty())
   {
     drawString(pos, DISP_HEIGHT - 1 - 2, statusStr, RIGHT, ACCENT_COLOR);
     pos -= getStringWidth(statusStr) + 24;
-    display.drawInvertedBitmap(pos, DISP_HEIGHT - 1 - 18, error_icon_24x24,
-                               24, 24, ACCENT_COLOR);
+    drawIcon(pos, DISP_HEIGHT - 1 - 18, error_icon_24x24,
+             24, 24, ACCENT_COLOR);
   }
+  endRegion(REGION_STATUS_BAR);
 }
 
 /* 绘制错误界面 */
 void drawError(const uint8_t *bitmap_196x196,
                const String &errMsgLn1, const String &errMsgLn2)
 {
-  display.setFont(&FONT_26pt8b);
+  lastFrameHash = 0;
+#if PARTIAL_REFRESH
+  memset(panelRegions, 0, sizeof(panelRegions));
+#endif
+  setFont(&FONT_26pt8b);
   if (!errMsgLn2.isEmpty())
   {
     drawString(DISP_WIDTH / 2, DISP_HEIGHT / 2 + 196 / 2 + 21,
@@ -233,3 +737,111 @@ void drawError(const uint8_t *bitmap_196x196,
                              bitmap_196x196, 196, 196, ACCENT_COLOR);
 }
 
+
+static uint32_t hashString(const char *s, uint32_t hash)
+{
+  // 包含结尾的 '\0'，以区分相邻字段的边界
+  return fnv1a32(s, strlen(s) + 1, hash);
+}
+
+static uint32_t hashInt(int32_t v, uint32_t hash)
+{
+  return fnv1a32(&v, sizeof(v), hash);
+}
+
+/* 按显示精度对一帧的全部输入计算哈希
+ * 刷新时间不参与计算，其更新频率由 FORCE_REFRESH_INTERVAL 决定
+ */
+uint32_t hashFrameContent(const cma_weather_t w[], const int status[],
+                          size_t count,
+                          float inTemp, float inHumidity,
+                          const String &city, const String &date,
+                          const String &statusStr,
+                          int rssi, uint32_t batVoltage)
+{
+  uint32_t h = fnv1a32(NULL, 0);
+  for (size_t i = 0; i < count; ++i)
+  {
+    h = hashInt(status[i], h);
+    h = hashString(w[i].weather1, h);
+    h = hashString(w[i].weather2, h);
+    h = hashString(w[i].windDirection, h);
+    h = hashString(w[i].place, h);
+    h = hashInt(lroundf(w[i].temperature * 10), h);
+    h = hashInt(w[i].humidity, h);
+    h = hashInt(w[i].windScaleLevel, h);
+    h = hashInt(lroundf(w[i].windSpeed * 10), h);
+    h = hashInt(lroundf(w[i].precipitation * 10), h);
+  }
+  h = hashInt(std::isnan(inTemp) ? INT32_MIN : lroundf(inTemp * 10), h);
+  h = hashInt(std::isnan(inHumidity) ? INT32_MIN : lroundf(inHumidity * 10),
+              h);
+  h = hashString(city.c_str(), h);
+  h = hashString(date.c_str(), h);
+  h = hashString(statusStr.c_str(), h);
+  h = hashString(getWiFidesc(rssi), h);
+#if BATTERY_MONITORING
+  h = hashInt(calcBatPercent(batVoltage, MIN_BATTERY_VOLTAGE,
+                             MAX_BATTERY_VOLTAGE), h);
+#endif
+  return h == 0 ? 1 : h;
+}
+
+/* 判断本次是否可以跳过面板刷新
+ * 内容与上次刷新相同且连续跳过次数未达到 FORCE_REFRESH_INTERVAL 时返回true
+ */
+bool skipFrameRefresh(uint32_t frameHash)
+{
+  if (frameHash != lastFrameHash || skippedRefreshes >= FORCE_REFRESH_INTERVAL)
+  {
+    return false;
+  }
+  ++skippedRefreshes;
+  return true;
+}
+
+/* 记录已刷新到面板上的内容 */
+void recordFrameRefresh(uint32_t frameHash)
+{
+  lastFrameHash = frameHash;
+  skippedRefreshes = 0;
+}
+
+#if PARTIAL_REFRESH
+/* 将缓冲区中的整帧推送到面板：只局部刷新内容发生变化的区域
+ *
+ * 区域变化时，其旧范围与新范围都需要刷新（旧内容要被擦除）。各变化区域合并为一个窗口
+ * 刷新一次，局部刷新的耗时主要取决于波形而非面积。面板画面未知、控制器未保持供电或
+ * 局部刷新次数达到 PARTIAL_REFRESH_FULL_EVERY 时进行全屏刷新。
+ */
+void refreshChangedRegions()
+{
+  bool full = !panelRetained || !panelRegionsKnown()
+              || partialRefreshes >= PARTIAL_REFRESH_FULL_EVERY;
+  rect_t dirty = {};
+  for (int i = 0; i < REGION_COUNT && !full; ++i)
+  {
+    if (drawnRegions[i].hash != panelRegions[i].hash)
+    {
+      dirty = unionRect(dirty, unionRect(panelRegions[i].rect,
+                                         drawnRegions[i].rect));
+    }
+  }
+
+  if (full)
+  {
+    display.display(false);
+    partialRefreshes = 0;
+  }
+  else if (dirty.w > 0 && dirty.h > 0)
+  {
+    int16_t x0 = std::max<int16_t>(dirty.x, 0);
+    int16_t y0 = std::max<int16_t>(dirty.y, 0);
+    int16_t x1 = std::min<int16_t>(dirty.x + dirty.w, DISP_WIDTH);
+    int16_t y1 = std::min<int16_t>(dirty.y + dirty.h, DISP_HEIGHT);
+    display.displayWindow(x0, y0, x1 - x0, y1 - y0);
+    ++partialRefreshes;
+  }
+  memcpy(panelRegions, drawnRegions, sizeof(panelRegions));
+}
+#endif
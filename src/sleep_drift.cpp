@@ -0,0 +1,114 @@
+/* 深度睡眠定时器漂移校准
+ *
+ * ESP32 的 RTC 慢时钟精度较差，且每块芯片的偏差不同。进入深度睡眠前记录
+ * 当前时间与设定的定时时长；下次由定时器唤醒、且时间已通过 SNTP 校准后（外部
+ * RTC 只有 1 秒分辨率，不用于观测），用实际睡眠时长与设定时长之比更新本机的
+ * 速率估计（指数加权平均，保存在 NVS 中），据此换算下一次的定时时长，使唤醒
+ * 时间准确落在对齐的分钟上。
+ */
+#include <cmath>
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_sleep.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "config.h"
+#include "sleep_drift.h"
+
+// 未校准时的默认速率：实际秒数 / 定时器秒数，多数芯片的 RTC 偏快约 0.15%
+static const float DEFAULT_SLEEP_RATE = 1.0f / 1.0015f;
+static const float SLEEP_RATE_EWMA_ALPHA = 0.25f;
+// 超出此范围的观测视为无效（如睡眠期间复位或时间源错误）
+static const float MIN_SLEEP_RATE = 0.95f;
+static const float MAX_SLEEP_RATE = 1.05f;
+// 短睡眠的观测受 1 秒分辨率影响过大，不参与校准
+static const uint64_t MIN_OBSERVED_SLEEP = 600; // 秒
+// 预留少量余量，宁可略晚也不在对齐时刻之前唤醒（提前唤醒会落到错误的时段）
+static const uint64_t WAKE_GUARD_SECONDS = 2;
+
+// 上次进入深度睡眠时的状态，sleepStartEpoch 为 0 表示无效
+static RTC_DATA_ATTR double sleepStartEpoch = 0;
+static RTC_DATA_ATTR uint64_t sleepTimerSeconds = 0;
+
+static double epochNow()
+{
+  timeval tv = {};
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static float loadSleepRate()
+{
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, true);
+  float rate = prefs.getFloat("slpRate", DEFAULT_SLEEP_RATE);
+  prefs.end();
+  return rate;
+}
+
+/* 用一次观测（实际秒数 / 定时器秒数）更新速率估计，返回新的估计
+ *
+ * 超出合理范围的观测视为无效，估计不变
+ */
+float updateSleepRate(float rate, float observed)
+{
+  if (observed < MIN_SLEEP_RATE || observed > MAX_SLEEP_RATE)
+  {
+    return rate;
+  }
+  return rate + SLEEP_RATE_EWMA_ALPHA * (observed - rate);
+}
+
+/* 按速率估计将期望的实际睡眠秒数换算为定时器秒数（含唤醒余量） */
+uint64_t sleepTimerFor(uint64_t sleepSeconds, float rate)
+{
+  return static_cast<uint64_t>(
+    ceil((sleepSeconds + WAKE_GUARD_SECONDS) / rate));
+}
+
+/* 根据本次唤醒的实际时间更新定时器速率估计
+ *
+ * 必须在系统时间已由 SNTP 设置之后调用
+ */
+void observeSleepDrift()
+{
+  double startEpoch = sleepStartEpoch;
+  uint64_t timerSeconds = sleepTimerSeconds;
+  sleepStartEpoch = 0;
+  if (startEpoch == 0
+   || timerSeconds < MIN_OBSERVED_SLEEP
+   || esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER)
+  {
+    return;
+  }
+
+  double wakeEpoch = epochNow() - millis() / 1000.0;
+  float observed = (wakeEpoch - startEpoch) / timerSeconds;
+  float oldRate = loadSleepRate();
+  float rate = updateSleepRate(oldRate, observed);
+  if (rate == oldRate)
+  {
+    return;
+  }
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, false);
+  prefs.putFloat("slpRate", rate);
+  prefs.end();
+#if DEBUG_LEVEL >= 1
+  Serial.printf("[调试] 睡眠定时器速率 %.5f（本次 %.5f）\n", rate, observed);
+#endif
+} // end observeSleepDrift
+
+/* 将期望的实际睡眠秒数换算为定时器秒数，并记录本次睡眠的起点
+ */
+uint64_t calibrateSleepDuration(uint64_t sleepSeconds)
+{
+  uint64_t timerSeconds = sleepTimerFor(sleepSeconds, loadSleepRate());
+
+  // 系统时间在首次授时前无意义，此时不记录起点
+  double now = epochNow();
+  sleepStartEpoch = now > 1577836800.0 ? now : 0; // 2020-01-01
+  sleepTimerSeconds = timerSeconds;
+  return timerSeconds;
+} // end calibrateSleepDuration
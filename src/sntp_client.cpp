@@ -0,0 +1,205 @@
+/* 单次交换的 SNTP 客户端（RFC 4330）
+ *
+ * lwIP 的 SNTP 服务按轮询周期工作，首次同步往往需要数秒。这里向各服务器同时发送
+ * 一个请求，以 select() 等待，采用第一个有效的响应：按往返时间补偿网络延迟后直接
+ * 设置系统时钟，网络正常时只需几十毫秒。NTP_RETRY_INTERVAL 内没有响应则重发。
+ *
+ * 请求的发送时间戳字段填入随机数，响应的原始时间戳必须与之相同，用于丢弃过期
+ * 或伪造的响应。延迟按 esp_timer 计算，与系统时钟当前是否已设置无关。
+ */
+#include <algorithm>
+#include <cstring>
+#include <Arduino.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "config.h"
+#include "dns_cache.h"
+#include "sntp_client.h"
+
+static const uint16_t NTP_PORT = 123;
+static const size_t NTP_PACKET_SIZE = 48;
+static const size_t NTP_MAX_SERVERS = 2;
+// 未收到响应时重发请求的间隔
+static const unsigned long NTP_RETRY_INTERVAL = 1000; // 毫秒
+// 1900-01-01 到 1970-01-01 的秒数
+static const uint64_t NTP_UNIX_OFFSET = 2208988800ULL;
+
+static const uint8_t NTP_LI_UNSYNC   = 3;
+static const uint8_t NTP_VERSION     = 4;
+static const uint8_t NTP_MODE_CLIENT = 3;
+static const uint8_t NTP_MODE_SERVER = 4;
+
+// 包内字段偏移
+static const size_t NTP_OFF_STRATUM  = 1;
+static const size_t NTP_OFF_ORIGIN   = 24;
+static const size_t NTP_OFF_RECEIVE  = 32;
+static const size_t NTP_OFF_TRANSMIT = 40;
+
+typedef struct {
+  sockaddr_in addr;
+  uint8_t     nonce[8]; // 最近一次请求的发送时间戳字段
+  int64_t     sentUs;   // 最近一次请求的发送时刻（esp_timer）
+} ntp_server_t;
+
+static uint32_t readBE32(const uint8_t *p)
+{
+  return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8)
+         | p[3];
+}
+
+/* NTP 时间戳转换为 Unix 时间（微秒） */
+static int64_t ntpToUnixUs(const uint8_t *p)
+{
+  uint64_t sec = readBE32(p);
+  uint32_t frac = readBE32(p + 4);
+  if (!(sec & 0x80000000))
+  { // 最高位为 0 时属于 2036 年之后的下一个纪元
+    sec += 0x100000000ULL;
+  }
+  return static_cast<int64_t>(sec - NTP_UNIX_OFFSET) * 1000000
+         + ((static_cast<uint64_t>(frac) * 1000000) >> 32);
+}
+
+static bool sendRequest(int sock, ntp_server_t &server)
+{
+  uint8_t packet[NTP_PACKET_SIZE] = {};
+  packet[0] = (NTP_VERSION << 3) | NTP_MODE_CLIENT;
+  uint32_t r[2] = {esp_random(), esp_random()};
+  memcpy(server.nonce, r, sizeof(server.nonce));
+  memcpy(packet + NTP_OFF_TRANSMIT, server.nonce, sizeof(server.nonce));
+  server.sentUs = esp_timer_get_time();
+  return sendto(sock, packet, sizeof(packet), 0,
+                reinterpret_cast<const sockaddr *>(&server.addr),
+                sizeof(server.addr)) == sizeof(packet);
+}
+
+/* 校验响应并计算接收时刻对应的 Unix 时间（微秒），无效时返回false */
+static bool parseResponse(const uint8_t *packet, size_t len,
+                          const ntp_server_t &server, int64_t recvUs,
+                          int64_t &unixUs)
+{
+  if (len < NTP_PACKET_SIZE)
+  {
+    return false;
+  }
+  uint8_t li      = packet[0] >> 6;
+  uint8_t mode    = packet[0] & 0x07;
+  uint8_t stratum = packet[NTP_OFF_STRATUM];
+  if (li == NTP_LI_UNSYNC
+   || mode != NTP_MODE_SERVER
+   || stratum == 0 || stratum > 15 // 0 为 Kiss-o'-Death
+   || memcmp(packet + NTP_OFF_ORIGIN, server.nonce, sizeof(server.nonce)) != 0
+   || readBE32(packet + NTP_OFF_TRANSMIT) == 0)
+  {
+    return false;
+  }
+
+  int64_t t2 = ntpToUnixUs(packet + NTP_OFF_RECEIVE);
+  int64_t t3 = ntpToUnixUs(packet + NTP_OFF_TRANSMIT);
+  // 往返延迟扣除服务器处理时间，单程按一半计
+  int64_t delay = (recvUs - server.sentUs) - (t3 - t2);
+  if (delay < 0)
+  {
+    delay = 0;
+  }
+  unixUs = t3 + delay / 2;
+#if DEBUG_LEVEL >= 1
+  Serial.printf("SNTP 响应：%s，层级 %u，往返 %lldms\n",
+                inet_ntoa(server.addr.sin_addr), stratum,
+                (recvUs - server.sentUs) / 1000);
+#endif
+  return true;
+}
+
+/* 向各服务器同时查询时间，用第一个有效响应设置系统时钟（时区为 TIMEZONE）
+ *
+ * 服务器地址优先取自 DNS 缓存。在 timeoutMs 内成功返回true
+ */
+bool sntpSyncTime(const char *const servers[], size_t count,
+                  unsigned long timeoutMs)
+{
+  ntp_server_t targets[NTP_MAX_SERVERS] = {};
+  size_t n = 0;
+  for (size_t i = 0; i < count && n < NTP_MAX_SERVERS; ++i)
+  {
+    IPAddress ip;
+    if (!resolveHost(servers[i], ip))
+    {
+      continue;
+    }
+    targets[n].addr.sin_family      = AF_INET;
+    targets[n].addr.sin_port        = htons(NTP_PORT);
+    targets[n].addr.sin_addr.s_addr = static_cast<uint32_t>(ip);
+    ++n;
+  }
+  if (n == 0)
+  {
+    return false;
+  }
+
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (sock < 0)
+  {
+    return false;
+  }
+
+  const unsigned long start = millis();
+  unsigned long lastSend = start;
+  bool sent = false;
+  bool synced = false;
+  while (!synced && millis() - start < timeoutMs)
+  {
+    if (!sent || millis() - lastSend >= NTP_RETRY_INTERVAL)
+    {
+      for (size_t i = 0; i < n; ++i)
+      {
+        sendRequest(sock, targets[i]);
+      }
+      lastSend = millis();
+      sent = true;
+    }
+
+    unsigned long waitMs = std::min(NTP_RETRY_INTERVAL
+                                    - (millis() - lastSend),
+                                    timeoutMs - (millis() - start));
+    timeval tv = {static_cast<time_t>(waitMs / 1000),
+                  static_cast<suseconds_t>(waitMs % 1000 * 1000)};
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(sock, &readSet);
+    if (select(sock + 1, &readSet, NULL, NULL, &tv) <= 0)
+    {
+      continue;
+    }
+
+    uint8_t packet[NTP_PACKET_SIZE];
+    sockaddr_in from = {};
+    socklen_t fromLen = sizeof(from);
+    int len = recvfrom(sock, packet, sizeof(packet), 0,
+                       reinterpret_cast<sockaddr *>(&from), &fromLen);
+    int64_t recvUs = esp_timer_get_time();
+    for (size_t i = 0; i < n && len > 0; ++i)
+    {
+      int64_t unixUs;
+      if (from.sin_addr.s_addr == targets[i].addr.sin_addr.s_addr
+       && from.sin_port == targets[i].addr.sin_port
+       && parseResponse(packet, len, targets[i], recvUs, unixUs))
+      {
+        unixUs += esp_timer_get_time() - recvUs;
+        timeval now = {static_cast<time_t>(unixUs / 1000000),
+                       static_cast<suseconds_t>(unixUs % 1000000)};
+        settimeofday(&now, NULL);
+        setenv("TZ", TIMEZONE, 1);
+        tzset();
+        synced = true;
+        break;
+      }
+    }
+  }
+  close(sock);
+  return synced;
+} // end sntpSyncTime
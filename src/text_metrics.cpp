@@ -0,0 +1,199 @@
+/* 文本尺寸测量与缓存
+ *
+ * Adafruit_GFX::getTextBounds() 逐字符调用 charBounds()，每次都要处理文字缩放与
+ * 自动换行；drawString() 为对齐测量一次，drawStatusBar() 又为排版测量同一字符串，
+ * 分页绘制时每页还要重复一遍。这里直接按 GFXfont 的字形表（位于内存映射的 flash，
+ * 本身就是每个字体只有一份的逐字形度量表）累加计算外接矩形，结果按
+ * 字体指针与字符串哈希缓存在直接映射的表中，重复测量只需一次查表。
+ *
+ * 文本按 UTF-8 解码：GFX 字体覆盖的字符（8 位字体为 U+0020..U+00FF）使用其字形，
+ * 其余字符使用通过 registerCjkFont() 与该 GFX 字体配对的中文字体。不是合法 UTF-8
+ * 的字节按 Latin-1 处理，兼容区域设置中以 "\260C" 形式书写的字符串。
+ *
+ * 渲染器按同样的规则逐字绘制（见 renderer.cpp 中的 drawGlyphs()），测量结果与
+ * 绘制一致的前提是文字缩放为 1、关闭自动换行（initDisplay() 中设置），且文本为单行。
+ */
+#include <algorithm>
+#include <cstring>
+#include <Arduino.h>
+
+#include "cma_codes.h"
+#include "display_utils.h"
+#include "text_metrics.h"
+
+static const size_t TEXT_CACHE_SIZE = 32; // 须为 2 的幂
+static const size_t CJK_FONT_SLOTS  = 8;
+
+typedef struct {
+  const GFXfont    *font;
+  const cjk_font_t *cjk;
+} cjk_pair_t;
+
+typedef struct {
+  uint32_t       key;  // 字体与文本的哈希，0 表示空
+  const GFXfont *font; // 与哈希一同比较，降低哈希碰撞返回错误结果的可能
+  uint16_t       len;
+  text_bounds_t  bounds;
+} text_cache_entry_t;
+
+static text_cache_entry_t textCache[TEXT_CACHE_SIZE];
+static uint32_t cacheHits   = 0;
+static uint32_t cacheMisses = 0;
+static cjk_pair_t cjkFonts[CJK_FONT_SLOTS];
+
+/* 为 GFX 字体配对中文字体，font 中没有的字符将从 cjk 中查找 */
+void registerCjkFont(const GFXfont *font, const cjk_font_t *cjk)
+{
+  for (cjk_pair_t &pair : cjkFonts)
+  {
+    if (pair.font == NULL || pair.font == font)
+    {
+      pair = {font, cjk};
+      memset(textCache, 0, sizeof(textCache));
+      return;
+    }
+  }
+  log_e("中文字体配对已满");
+}
+
+/* 解码 p 处的一个字符并前移 p，字符串结束返回 0
+ *
+ * 不是合法 UTF-8 序列开头的字节按 Latin-1 返回其字节值
+ */
+uint32_t nextTextChar(const char *&p)
+{
+  const char *start = p;
+  uint32_t cp = utf8Next(p);
+  if (cp == 0xFFFD && p - start == 1)
+  {
+    return static_cast<uint8_t>(*start);
+  }
+  return cp;
+}
+
+/* 取得字符在 font（及与之配对的中文字体）中的字形，都没有时返回false */
+bool lookupGlyph(const GFXfont *font, uint32_t cp, glyph_info_t &g)
+{
+  if (font == NULL)
+  { // 内置 5x7 字体，本项目不使用
+    return false;
+  }
+  if (cp >= font->first && cp <= font->last)
+  {
+    const GFXglyph &gg = font->glyph[cp - font->first];
+    g = {NULL, gg.width, gg.height, gg.xAdvance, gg.xOffset, gg.yOffset};
+    return true;
+  }
+  for (const cjk_pair_t &pair : cjkFonts)
+  {
+    if (pair.font != font)
+    {
+      continue;
+    }
+    const cjk_glyph_t *cg = findCjkGlyph(pair.cjk, cp);
+    if (cg == NULL)
+    {
+      return false;
+    }
+    g = {pair.cjk->bitmap + cg->bitmapOffset, cg->width, cg->height,
+         cg->xAdvance, cg->xOffset, cg->yOffset};
+    return true;
+  }
+  return false;
+}
+
+/* 按字形表计算外接矩形，规则与 Adafruit_GFX::charBounds() 相同 */
+static text_bounds_t computeBounds(const GFXfont *font, const char *text,
+                                   size_t len)
+{
+  int16_t x = 0;
+  int16_t minx = INT16_MAX, miny = INT16_MAX;
+  int16_t maxx = -1, maxy = -1;
+  glyph_info_t g;
+  for (const char *p = text, *end = text + len; p < end; )
+  {
+    uint32_t cp = nextTextChar(p);
+    if (cp == 0)
+    {
+      break;
+    }
+    if (!lookupGlyph(font, cp, g))
+    {
+      continue;
+    }
+    if (g.width > 0 && g.height > 0)
+    { // 没有位图的字形（如空格）只影响位置
+      int16_t x1 = x + g.xOffset;
+      int16_t y1 = g.yOffset;
+      minx = std::min<int16_t>(minx, x1);
+      miny = std::min<int16_t>(miny, y1);
+      maxx = std::max<int16_t>(maxx, x1 + g.width - 1);
+      maxy = std::max<int16_t>(maxy, y1 + g.height - 1);
+    }
+    x += g.xAdvance;
+  }
+
+  text_bounds_t b = {};
+  if (maxx >= minx)
+  {
+    b.x1 = minx;
+    b.w  = maxx - minx + 1;
+  }
+  if (maxy >= miny)
+  {
+    b.y1 = miny;
+    b.h  = maxy - miny + 1;
+  }
+  return b;
+}
+
+/* 测量文本 text[0, len) 的外接矩形（相对于基线起点），结果会被缓存 */
+text_bounds_t measureText(const GFXfont *font, const char *text, size_t len)
+{
+  if (font == NULL)
+  { // 内置 5x7 字体，本项目不使用
+    return {};
+  }
+  uint32_t key = fnv1a32(&font, sizeof(font));
+  key = fnv1a32(text, len, key);
+  key = key == 0 ? 1 : key;
+  text_cache_entry_t &entry = textCache[key & (TEXT_CACHE_SIZE - 1)];
+  if (entry.key == key && entry.font == font && entry.len == len)
+  {
+    ++cacheHits;
+    return entry.bounds;
+  }
+  ++cacheMisses;
+  entry.key    = key;
+  entry.font   = font;
+  entry.len    = len;
+  entry.bounds = computeBounds(font, text, len);
+  return entry.bounds;
+}
+
+/* 文本 text[0, len) 的步进宽度（绘制后光标移动的距离），直接累加字形表 */
+uint16_t measureAdvance(const GFXfont *font, const char *text, size_t len)
+{
+  uint16_t advance = 0;
+  glyph_info_t g;
+  for (const char *p = text, *end = text + len; font != NULL && p < end; )
+  {
+    uint32_t cp = nextTextChar(p);
+    if (cp == 0)
+    {
+      break;
+    }
+    if (lookupGlyph(font, cp, g))
+    {
+      advance += g.xAdvance;
+    }
+  }
+  return advance;
+}
+
+/* 缓存命中与未命中次数 */
+void getTextMetricsStats(uint32_t &hits, uint32_t &misses)
+{
+  hits   = cacheHits;
+  misses = cacheMisses;
+}
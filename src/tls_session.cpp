@@ -0,0 +1,296 @@
+/* 可跨深度睡眠恢复 TLS 会话的安全客户端
+ *
+ * WiFiClientSecure 的 start_ssl_client() 在一个函数内完成 mbedtls_ssl_setup() 与
+ * 握手，无法在两者之间调用 mbedtls_ssl_set_session()。这里按相同步骤重新实现连接
+ * 过程（仅支持本项目使用的 CA 证书校验与不校验两种模式），在握手前提供保存的会话。
+ *
+ * 请求成功后调用 saveSession()，会话（会话 ID 或会话票据）经 mbedtls_ssl_session_save()
+ * 序列化后保存在 RTC 内存中，以主机名与端口标识。以下情况不再提供该会话：
+ *   - 超过服务器给出的票据有效期或 TLS_SESSION_MAX_AGE
+ *   - 提供会话后握手失败（服务器拒绝时 mbedTLS 会自动进行完整握手，不会失败）
+ *   - 固件更新导致 mbedTLS 配置变化（反序列化失败）
+ */
+#include <algorithm>
+#include <cstring>
+#include <Arduino.h>
+#include <lwip/sockets.h>
+#include <time.h>
+#include <WiFi.h>
+
+#include "config.h"
+#include "display_utils.h"
+#include "tls_session.h"
+
+// 序列化会话的大小上限，含服务器证书时约 1.5~2KB
+static const size_t TLS_SESSION_MAX_SIZE = 2560;
+// 早于此时间说明系统时间未设置，无法判断会话是否过期
+static const time_t MIN_VALID_EPOCH = 1700000000;
+
+typedef struct {
+  uint32_t key;     // 主机名与端口的哈希，0 表示无效
+  time_t   expires; // 过期时间（UTC）
+  uint16_t len;
+  uint8_t  data[TLS_SESSION_MAX_SIZE];
+} tls_session_cache_t;
+
+static RTC_DATA_ATTR tls_session_cache_t sessionCache;
+
+static uint32_t sessionKey(const char *host, uint16_t port)
+{
+  uint32_t key = fnv1a32(host, strlen(host));
+  key = fnv1a32(&port, sizeof(port), key);
+  return key == 0 ? 1 : key;
+}
+
+static int sslError(int err)
+{
+  char buf[128];
+  mbedtls_strerror(err, buf, sizeof(buf));
+  log_e("mbedTLS 错误 -0x%04X：%s", -err, buf);
+  return err;
+}
+
+/* 将保存的会话提供给即将进行的握手 */
+static void offerSession(mbedtls_ssl_context *ssl, uint32_t key)
+{
+  if (sessionCache.key != key || time(NULL) >= sessionCache.expires)
+  {
+    sessionCache.key = 0;
+    return;
+  }
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  if (mbedtls_ssl_session_load(&session, sessionCache.data,
+                               sessionCache.len) == 0)
+  {
+    mbedtls_ssl_set_session(ssl, &session); // 复制会话
+  }
+  else
+  {
+    sessionCache.key = 0;
+  }
+  mbedtls_ssl_session_free(&session);
+}
+
+/* 建立 TCP 连接，成功返回套接字，失败返回 -1 */
+static int connectSocket(IPAddress ip, uint16_t port, int32_t timeout)
+{
+  int fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0)
+  {
+    return -1;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = ip;
+  addr.sin_port = htons(port);
+  timeval tv = {timeout / 1000, (timeout % 1000) * 1000};
+
+  int res = lwip_connect(fd, reinterpret_cast<sockaddr *>(&addr),
+                         sizeof(addr));
+  if (res < 0 && errno != EINPROGRESS)
+  {
+    lwip_close(fd);
+    return -1;
+  }
+  fd_set fdset;
+  FD_ZERO(&fdset);
+  FD_SET(fd, &fdset);
+  int sockerr = 0;
+  socklen_t len = sizeof(sockerr);
+  if (select(fd + 1, NULL, &fdset, NULL, &tv) <= 0
+   || getsockopt(fd, SOL_SOCKET, SO_ERROR, &sockerr, &len) < 0
+   || sockerr != 0)
+  {
+    lwip_close(fd);
+    return -1;
+  }
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+  int enable = 1;
+  lwip_setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  lwip_setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  lwip_setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+  return fd;
+}
+
+/* 与 start_ssl_client() 步骤相同，另在握手前提供保存的会话
+ *
+ * 成功返回套接字，失败返回负数
+ */
+int ResumableClientSecure::startSslClient(IPAddress ip, uint16_t port,
+                                          const char *host, int32_t timeout)
+{
+  static const char *pers = "esp32-tls";
+  if (_CA_cert == NULL && !_use_insecure)
+  {
+    return -1;
+  }
+
+  ssl_init(sslclient);
+  sslclient->socket = connectSocket(ip, port, timeout > 0 ? timeout : 30000);
+  if (sslclient->socket < 0)
+  {
+    return -1;
+  }
+
+  int ret;
+  mbedtls_entropy_init(&sslclient->entropy_ctx);
+  if ((ret = mbedtls_ctr_drbg_seed(&sslclient->drbg_ctx, mbedtls_entropy_func,
+                                   &sslclient->entropy_ctx,
+                                   (const unsigned char *)pers,
+                                   strlen(pers))) != 0
+   || (ret = mbedtls_ssl_config_defaults(&sslclient->ssl_conf,
+                                         MBEDTLS_SSL_IS_CLIENT,
+                                         MBEDTLS_SSL_TRANSPORT_STREAM,
+                                         MBEDTLS_SSL_PRESET_DEFAULT)) != 0)
+  {
+    return sslError(ret);
+  }
+
+  if (_use_insecure)
+  {
+    mbedtls_ssl_conf_authmode(&sslclient->ssl_conf, MBEDTLS_SSL_VERIFY_NONE);
+  }
+  else
+  {
+    mbedtls_x509_crt_init(&sslclient->ca_cert);
+    mbedtls_ssl_conf_authmode(&sslclient->ssl_conf,
+                              MBEDTLS_SSL_VERIFY_REQUIRED);
+    ret = mbedtls_x509_crt_parse(&sslclient->ca_cert,
+                                 (const unsigned char *)_CA_cert,
+                                 strlen(_CA_cert) + 1);
+    mbedtls_ssl_conf_ca_chain(&sslclient->ssl_conf, &sslclient->ca_cert, NULL);
+    if (ret < 0)
+    {
+      mbedtls_x509_crt_free(&sslclient->ca_cert);
+      return sslError(ret);
+    }
+  }
+
+  mbedtls_ssl_conf_rng(&sslclient->ssl_conf, mbedtls_ctr_drbg_random,
+                       &sslclient->drbg_ctx);
+  if ((ret = mbedtls_ssl_set_hostname(&sslclient->ssl_ctx, host)) != 0
+   || (ret = mbedtls_ssl_setup(&sslclient->ssl_ctx,
+                               &sslclient->ssl_conf)) != 0)
+  {
+    return sslError(ret);
+  }
+  offerSession(&sslclient->ssl_ctx, _sessionKey);
+  mbedtls_ssl_set_bio(&sslclient->ssl_ctx, &sslclient->socket,
+                      mbedtls_net_send, mbedtls_net_recv, NULL);
+
+  unsigned long handshakeStart = millis();
+  while ((ret = mbedtls_ssl_handshake(&sslclient->ssl_ctx)) != 0)
+  {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      sessionCache.key = 0;
+      return sslError(ret);
+    }
+    if (millis() - handshakeStart > sslclient->handshake_timeout)
+    {
+      sessionCache.key = 0;
+      return -1;
+    }
+    vTaskDelay(2);
+  }
+
+  if (mbedtls_ssl_get_verify_result(&sslclient->ssl_ctx) != 0)
+  {
+    sessionCache.key = 0;
+    log_e("服务器证书校验失败");
+    return -1;
+  }
+  if (!_use_insecure)
+  {
+    mbedtls_x509_crt_free(&sslclient->ca_cert);
+  }
+#if DEBUG_LEVEL >= 1
+  Serial.printf("TLS 握手 %lums\n", millis() - handshakeStart);
+#endif
+  return sslclient->socket;
+} // end startSslClient
+
+/* 连接到已解析的地址，host 用于 SNI、证书校验与会话匹配
+ *
+ * 成功返回1，失败返回0
+ */
+int ResumableClientSecure::connect(IPAddress ip, uint16_t port,
+                                   const char *host, int32_t timeout)
+{
+  _sessionKey = sessionKey(host, port);
+  int ret = startSslClient(ip, port, host, timeout);
+  _lastError = ret;
+  if (ret < 0)
+  {
+    stop();
+    return 0;
+  }
+  _connected = true;
+  return 1;
+}
+
+int ResumableClientSecure::connect(const char *host, uint16_t port,
+                                   int32_t timeout)
+{
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip))
+  {
+    return 0;
+  }
+  return connect(ip, port, host, timeout);
+}
+
+int ResumableClientSecure::connect(const char *host, uint16_t port)
+{
+  return connect(host, port, _timeout);
+}
+
+/* 将当前连接的 TLS 会话保存到 RTC 内存，供下次唤醒时恢复
+ *
+ * 应在请求成功后、stop() 之前调用。成功返回true
+ */
+bool ResumableClientSecure::saveSession()
+{
+  time_t now = time(NULL);
+  if (!_connected || now < MIN_VALID_EPOCH)
+  {
+    return false;
+  }
+
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  size_t len = 0;
+  int ret = mbedtls_ssl_get_session(&sslclient->ssl_ctx, &session);
+  if (ret == 0)
+  {
+    ret = mbedtls_ssl_session_save(&session, sessionCache.data,
+                                   sizeof(sessionCache.data), &len);
+  }
+  time_t maxAge = TLS_SESSION_MAX_AGE;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  if (ret == 0 && session.ticket_len > 0 && session.ticket_lifetime > 0)
+  { // 服务器给出的票据有效期
+    maxAge = std::min<time_t>(maxAge, session.ticket_lifetime);
+  }
+#endif
+  mbedtls_ssl_session_free(&session);
+
+  if (ret != 0)
+  {
+    sessionCache.key = 0;
+    if (ret == MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL)
+    {
+      Serial.printf("TLS 会话过大（%u字节），无法保存\n", len);
+    }
+    return false;
+  }
+  sessionCache.key = _sessionKey;
+  sessionCache.expires = now + maxAge;
+  sessionCache.len = len;
+  return true;
+} // end saveSession
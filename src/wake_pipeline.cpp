@@ -0,0 +1,97 @@
+/* 唤醒流水线：WiFi 连接期间并行初始化外设
+ *
+ * WiFi 关联与 DHCP 往往需要数秒，期间主任务只是在等待。外设任务在另一核心上
+ * 读取 SHT30 与外部 RTC，并完成墨水屏的上电、复位与 SPI 初始化，
+ * 通过事件组通知主任务各部分已就绪。
+ */
+#include <Arduino.h>
+#include <Adafruit_SHT31.h>
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+
+#include "_locale.h"
+#include "config.h"
+#include "ext_rtc.h"
+#include "renderer.h"
+#include "wake_pipeline.h"
+#include "wake_profiler.h"
+
+static const EventBits_t PERIPHERALS_READY = BIT0;
+static const EventBits_t DISPLAY_READY     = BIT1;
+
+static EventGroupHandle_t pipelineEvents = NULL;
+static peripheral_data_t peripheralData = {};
+
+/* 外设任务：读取传感器与外部 RTC，然后初始化墨水屏 */
+static void peripheralTask(void *param)
+{
+  PCF8563_Class *rtc = static_cast<PCF8563_Class *>(param);
+
+  // SHT30 与 RTC 共用 setup() 中已初始化的 I2C 总线
+  profilerStart(PROF_SHT30_READ);
+  Adafruit_SHT31 sht30 = Adafruit_SHT31(&Wire);
+  peripheralData.inTemp     = NAN;
+  peripheralData.inHumidity = NAN;
+  peripheralData.sht30Found = sht30.begin(SHT30_ADDRESS);
+  if (peripheralData.sht30Found)
+  {
+    peripheralData.inTemp     = sht30.readTemperature(); // 摄氏度
+    peripheralData.inHumidity = sht30.readHumidity();    // %
+  }
+  profilerStop(PROF_SHT30_READ);
+
+  peripheralData.rtcTime   = rtc->getDateTime();
+  peripheralData.rtcReadMs = millis();
+  peripheralData.rtcIntegrity = readExtRtcIntegrity();
+  xEventGroupSetBits(pipelineEvents, PERIPHERALS_READY);
+
+  profilerStart(PROF_DISPLAY_INIT);
+  initDisplay();
+  profilerStop(PROF_DISPLAY_INIT);
+  xEventGroupSetBits(pipelineEvents, DISPLAY_READY);
+
+  vTaskDelete(NULL);
+} // end peripheralTask
+
+/* 在另一核心上启动外设任务，应在 WiFi 开始连接后立即调用
+ */
+void startPeripheralTask(PCF8563_Class &rtc)
+{
+  pipelineEvents = xEventGroupCreate();
+  // setup() 运行在 ARDUINO_RUNNING_CORE 上，外设任务放在另一个核心
+  xTaskCreatePinnedToCore(peripheralTask, "peripherals", 6144, &rtc, 1, NULL,
+                          ARDUINO_RUNNING_CORE == 0 ? 1 : 0);
+} // end startPeripheralTask
+
+/* 等待 SHT30 与外部 RTC 读取完成
+ */
+const peripheral_data_t &waitForPeripherals()
+{
+  xEventGroupWaitBits(pipelineEvents, PERIPHERALS_READY,
+                      pdFALSE, pdTRUE, portMAX_DELAY);
+  Serial.print(String(TXT_READING_FROM) + " SHT30... ");
+  if (!peripheralData.sht30Found)
+  {
+    Serial.println(TXT_NOT_FOUND);
+  }
+  else if (std::isnan(peripheralData.inTemp)
+        || std::isnan(peripheralData.inHumidity))
+  {
+    Serial.println(TXT_READ_FAILED);
+  }
+  else
+  {
+    Serial.println(TXT_SUCCESS);
+  }
+  return peripheralData;
+} // end waitForPeripherals
+
+/* 等待墨水屏初始化完成，之后即可开始绘制
+ */
+void waitForDisplay()
+{
+  xEventGroupWaitBits(pipelineEvents, DISPLAY_READY,
+                      pdFALSE, pdTRUE, portMAX_DELAY);
+} // end waitForDisplay
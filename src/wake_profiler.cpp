@@ -0,0 +1,118 @@
+/* 唤醒周期分阶段计时
+ *
+ * 每次唤醒的各阶段耗时累计在普通内存中，进入深度睡眠前写入 RTC 内存中的
+ * 环形缓冲区。缓冲区每写满一轮（DEBUG_LEVEL >= 1 时为每次唤醒）通过串口
+ * 导出一次，格式如下（小端序，整体以十六进制编码输出在以 "PROF " 开头的一行中）：
+ *
+ *   头部   : 'W' 'P' 版本(u8) 阶段数(u8) 记录数(u8)
+ *   每条记录: 序号(u32) 唤醒时长ms(u32) 已执行阶段掩码(u16) 各阶段耗时ms(u16 x 阶段数)
+ *
+ * 记录按从旧到新的顺序输出。阶段耗时超过 65535ms 时饱和。
+ *
+ * 外设任务运行在另一个核心上，与 setup() 同时计时，对计时状态的修改由自旋锁保护。
+ */
+#include <Arduino.h>
+#include "config.h"
+#include "wake_profiler.h"
+
+#if WAKE_PROFILER
+
+static const uint8_t PROF_FORMAT_VERSION = 1;
+static const uint8_t PROF_RING_SIZE = 32;
+
+typedef struct {
+  uint32_t seq;
+  uint32_t awakeMs;
+  uint16_t ranMask;
+  uint16_t phaseMs[PROF_PHASE_COUNT];
+} prof_record_t;
+
+static_assert(PROF_PHASE_COUNT <= 16, "ranMask 只有 16 位");
+
+// 跨深度睡眠保存，冷启动时清零
+static RTC_DATA_ATTR prof_record_t profRing[PROF_RING_SIZE];
+static RTC_DATA_ATTR uint32_t profSeq = 0;
+
+// 当前唤醒的计时状态
+static unsigned long phaseStart[PROF_PHASE_COUNT];
+static prof_record_t current = {};
+static portMUX_TYPE profMux = portMUX_INITIALIZER_UNLOCKED;
+
+/* 开始（或继续）为某阶段计时 */
+void profilerStart(prof_phase_t phase)
+{
+  unsigned long now = millis();
+  portENTER_CRITICAL(&profMux);
+  phaseStart[phase] = now;
+  portEXIT_CRITICAL(&profMux);
+}
+
+/* 结束为某阶段计时，同一阶段多次计时会累加 */
+void profilerStop(prof_phase_t phase)
+{
+  unsigned long now = millis();
+  portENTER_CRITICAL(&profMux);
+  uint32_t total = current.phaseMs[phase] + (now - phaseStart[phase]);
+  current.phaseMs[phase] = total > UINT16_MAX ? UINT16_MAX : total;
+  current.ranMask |= 1U << phase;
+  portEXIT_CRITICAL(&profMux);
+}
+
+/* 将本次唤醒的记录写入 RTC 环形缓冲区，必要时导出 */
+void profilerCommit(unsigned long awakeMs)
+{
+  portENTER_CRITICAL(&profMux);
+  current.seq = profSeq;
+  current.awakeMs = awakeMs;
+  profRing[profSeq % PROF_RING_SIZE] = current;
+  portEXIT_CRITICAL(&profMux);
+  ++profSeq;
+#if DEBUG_LEVEL >= 1
+  profilerDump(Serial);
+#else
+  if (profSeq % PROF_RING_SIZE == 0)
+  {
+    profilerDump(Serial);
+  }
+#endif
+}
+
+static void printHexLE(Print &out, uint32_t v, uint8_t bytes)
+{
+  for (uint8_t i = 0; i < bytes; ++i)
+  {
+    out.printf("%02x", (v >> (8 * i)) & 0xFF);
+  }
+}
+
+/* 以紧凑二进制格式（十六进制编码）导出环形缓冲区 */
+void profilerDump(Print &out)
+{
+  uint8_t count = profSeq < PROF_RING_SIZE ? profSeq : PROF_RING_SIZE;
+  out.print("PROF ");
+  out.print("5750"); // 'W' 'P'
+  printHexLE(out, PROF_FORMAT_VERSION, 1);
+  printHexLE(out, PROF_PHASE_COUNT, 1);
+  printHexLE(out, count, 1);
+  for (uint32_t seq = profSeq - count; seq < profSeq; ++seq)
+  {
+    const prof_record_t &rec = profRing[seq % PROF_RING_SIZE];
+    printHexLE(out, rec.seq, 4);
+    printHexLE(out, rec.awakeMs, 4);
+    printHexLE(out, rec.ranMask, 2);
+    for (int i = 0; i < PROF_PHASE_COUNT; ++i)
+    {
+      printHexLE(out, rec.phaseMs[i], 2);
+    }
+  }
+  out.println();
+}
+
+#else
+
+void profilerStart(prof_phase_t phase) {}
+void profilerStop(prof_phase_t phase) {}
+void profilerCommit(unsigned long awakeMs) {}
+void profilerDump(Print &out) {}
+
+#endif
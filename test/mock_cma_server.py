@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""中国气象台接口的本地模拟服务器
+
+在局域网内代替 cn.apihz.cn，按场景返回各种异常的响应，用于比较 getCMAweather()
+在不同网络状况下的表现：在设备上见 DEBUG_LEVEL >= 1 时输出的 FETCH 统计行，
+在主机上见 test/test_fetch（pio test -e native -f test_fetch -v）。
+
+场景：
+  ok         正常响应
+  latency    等待 --delay 秒后响应
+  chunked    分块传输编码，每块 --chunk 字节（仅 HTTP/1.1 请求；HTTP/1.0 请求
+             不支持分块，改为带 Content-Length 分段发送）
+  truncated  Content-Length 为完整长度，只发送一半后关闭连接
+  slow       每 --delay 秒发送 --chunk 字节
+  status     返回 --status 指定的状态码
+  oversized  响应中附加大量过滤器会丢弃的字段（约 40KB）
+  drop       读取请求后直接关闭连接，不发送响应
+
+--script 按请求顺序指定场景，逗号分隔，如 "status:503,truncated,ok"；冒号后的
+参数覆盖该次请求的 --status（status）或 --delay（latency、slow）。脚本用完后
+重复最后一个场景。未指定时每个请求都使用 --scenario。
+
+请求头含 Accept-Encoding: gzip 时（--gzip）压缩响应体。
+
+用法：
+  python mock_cma_server.py --scenario slow --delay 0.5 --port 8080
+然后在 config.h 中定义 USE_HTTP，并在 config.cpp 中设置
+  CMA_ENDPOINT = "<本机地址>"，CMA_PORT = 8080
+--port 0 时由系统分配端口，启动后第一行输出实际端口。
+"""
+import argparse
+import gzip
+import json
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+RESPONSE = {
+    'precipitation': 0, 'temperature': 26.5, 'pressure': 1006,
+    'humidity': 60, 'windDirection': '东南风', 'windDirectionDegree': 138,
+    'windSpeed': 2.4, 'windScale': '微风', 'place': '中国, 北京, 北京',
+    'weather1': '多云', 'weather2': '晴', 'uptime': '2024/06/28 16:40',
+    'jieqi': '', 'code': 200,
+}
+
+SCENARIOS = ['ok', 'latency', 'chunked', 'truncated', 'slow', 'status',
+             'oversized', 'drop']
+
+
+def parse_step(step):
+    """解析脚本中的一步，返回 (场景, 参数或 None)"""
+    name, _, arg = step.strip().partition(':')
+    if name not in SCENARIOS:
+        raise argparse.ArgumentTypeError('未知场景：%s' % name)
+    return name, arg or None
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'  # 支持长连接，与设备端的连接复用配合
+
+    def next_step(self):
+        """取本次请求的场景与参数"""
+        server = self.server
+        args = server.args
+        if not args.script:
+            return args.scenario, None
+        with server.lock:
+            index = min(server.requests, len(args.script) - 1)
+            server.requests += 1
+        return args.script[index]
+
+    def do_GET(self):
+        args = self.server.args
+        scenario, arg = self.next_step()
+        status_code = args.status
+        delay = args.delay
+        if arg is not None:
+            if scenario == 'status':
+                status_code = int(arg)
+            else:
+                delay = float(arg)
+
+        start = time.monotonic()
+        if scenario == 'drop':
+            self.close_connection = True
+            self.log_message('drop')
+            return
+
+        body = dict(RESPONSE)
+        status = 200
+        if scenario == 'status':
+            status = status_code
+            body = {'code': status, 'msg': '模拟错误 %d' % status}
+        elif scenario == 'oversized':
+            body['hourly'] = [{'time': '%02d:00' % (i % 24),
+                               'temperature': 26.5, 'weather': '雷阵雨伴有冰雹'}
+                              for i in range(500)]
+        data = json.dumps(body, ensure_ascii=False).encode('utf-8')
+        encoding = None
+        if args.gzip and 'gzip' in self.headers.get('Accept-Encoding', ''):
+            data = gzip.compress(data)
+            encoding = 'gzip'
+        # HTTP/1.0 不支持分块传输编码
+        chunked = (scenario == 'chunked'
+                   and self.request_version == 'HTTP/1.1')
+
+        if scenario == 'latency':
+            time.sleep(delay)
+        self.send_response(status)
+        self.send_header('Content-Type', 'application/json; charset=utf-8')
+        if encoding:
+            self.send_header('Content-Encoding', encoding)
+        if self.close_connection:
+            self.send_header('Connection', 'close')
+        if chunked:
+            self.send_header('Transfer-Encoding', 'chunked')
+            self.end_headers()
+            for i in range(0, len(data), args.chunk):
+                piece = data[i:i + args.chunk]
+                self.wfile.write(b'%X\r\n%s\r\n' % (len(piece), piece))
+                self.wfile.flush()
+            self.wfile.write(b'0\r\n\r\n')
+        else:
+            self.send_header('Content-Length', str(len(data)))
+            self.end_headers()
+            if scenario == 'truncated':
+                self.wfile.write(data[:len(data) // 2])
+                self.close_connection = True
+            elif scenario in ('slow', 'chunked'):
+                for i in range(0, len(data), args.chunk):
+                    self.wfile.write(data[i:i + args.chunk])
+                    self.wfile.flush()
+                    if scenario == 'slow':
+                        time.sleep(delay)
+            else:
+                self.wfile.write(data)
+        self.wfile.flush()
+        self.log_message('%s %s %d %d 字节%s %.0fms', self.request_version,
+                         scenario, status, len(data),
+                         '（gzip）' if encoding else '',
+                         (time.monotonic() - start) * 1000)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='中国气象台接口的本地模拟服务器')
+    parser.add_argument('--scenario', choices=SCENARIOS, default='ok')
+    parser.add_argument('--script', default='',
+                        help='按请求顺序的场景列表，如 "status:503,ok"')
+    parser.add_argument('--port', type=int, default=8080)
+    parser.add_argument('--delay', type=float, default=2.0,
+                        help='latency 的等待秒数，slow 的发送间隔秒数')
+    parser.add_argument('--chunk', type=int, default=16,
+                        help='chunked 与 slow 每次发送的字节数')
+    parser.add_argument('--status', type=int, default=503,
+                        help='status 场景返回的状态码')
+    parser.add_argument('--gzip', action='store_true',
+                        help='客户端接受时以 gzip 压缩响应体')
+    args = parser.parse_args()
+    try:
+        args.script = [parse_step(s) for s in args.script.split(',')
+                       if s.strip()]
+    except argparse.ArgumentTypeError as e:
+        parser.error(str(e))
+
+    server = ThreadingHTTPServer(('', args.port), Handler)
+    server.args = args
+    server.lock = threading.Lock()
+    server.requests = 0
+    print('模拟服务器：端口 %d，场景 %s' % (
+        server.server_address[1],
+        ','.join(s for s, _ in args.script) if args.script else args.scenario))
+    sys.stdout.flush()
+    server.serve_forever()
+
+
+if __name__ == '__main__':
+    main()
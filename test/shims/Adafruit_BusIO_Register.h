@@ -0,0 +1,7 @@
+/* 主机上的 Adafruit BusIO 替身：参与主机测试的模块只包含此头文件，不使用 I2C/SPI */
+#ifndef __SHIM_ADAFRUIT_BUSIO_REGISTER_H__
+#define __SHIM_ADAFRUIT_BUSIO_REGISTER_H__
+
+#include <Arduino.h>
+
+#endif
@@ -0,0 +1,270 @@
+/* 主机上的 Adafruit_GFX.h 替身
+ *
+ * 只包含 Adafruit_GFX 与 GFXcanvas1，不含依赖 SPI/I2C 的显示驱动。渲染器用到的
+ * 图元（drawPixel、drawBitmap、drawChar、drawRoundRect 等）按 Adafruit GFX Library
+ * 的算法逐像素实现，GFXcanvas1 的缓冲区格式（每行按字节对齐，高位在左）也与之
+ * 相同，主机上绘制的结果与设备上的一致。
+ */
+#ifndef __SHIM_ADAFRUIT_GFX_H__
+#define __SHIM_ADAFRUIT_GFX_H__
+
+#include <cstdlib>
+#include <Arduino.h>
+#include <gfxfont.h>
+
+class Adafruit_GFX : public Print
+{
+public:
+  Adafruit_GFX(int16_t w, int16_t h)
+    : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+  virtual ~Adafruit_GFX() {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                        uint16_t color)
+  {
+    for (int16_t i = x; i < x + w; ++i)
+    {
+      drawFastVLine(i, y, h, color);
+    }
+  }
+  virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+  {
+    for (int16_t j = 0; j < h; ++j)
+    {
+      drawPixel(x, y + j, color);
+    }
+  }
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+  {
+    for (int16_t i = 0; i < w; ++i)
+    {
+      drawPixel(x + i, y, color);
+    }
+  }
+
+  void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername,
+                        uint16_t color)
+  {
+    int16_t f = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+    while (x < y)
+    {
+      if (f >= 0)
+      {
+        y--;
+        ddF_y += 2;
+        f += ddF_y;
+      }
+      x++;
+      ddF_x += 2;
+      f += ddF_x;
+      if (cornername & 0x4)
+      {
+        drawPixel(x0 + x, y0 + y, color);
+        drawPixel(x0 + y, y0 + x, color);
+      }
+      if (cornername & 0x2)
+      {
+        drawPixel(x0 + x, y0 - y, color);
+        drawPixel(x0 + y, y0 - x, color);
+      }
+      if (cornername & 0x8)
+      {
+        drawPixel(x0 - y, y0 + x, color);
+        drawPixel(x0 - x, y0 + y, color);
+      }
+      if (cornername & 0x1)
+      {
+        drawPixel(x0 - y, y0 - x, color);
+        drawPixel(x0 - x, y0 - y, color);
+      }
+    }
+  }
+
+  void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+                     uint16_t color)
+  {
+    int16_t max_radius = ((w < h) ? w : h) / 2;
+    if (r > max_radius)
+    {
+      r = max_radius;
+    }
+    drawFastHLine(x + r, y, w - 2 * r, color);
+    drawFastHLine(x + r, y + h - 1, w - 2 * r, color);
+    drawFastVLine(x, y + r, h - 2 * r, color);
+    drawFastVLine(x + w - 1, y + r, h - 2 * r, color);
+    drawCircleHelper(x + r, y + r, r, 1, color);
+    drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+    drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+    drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+  }
+
+  /* 单色位图，置位的点以 color 绘制 */
+  void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
+                  int16_t h, uint16_t color)
+  {
+    int16_t byteWidth = (w + 7) / 8;
+    uint8_t b = 0;
+    for (int16_t j = 0; j < h; j++, y++)
+    {
+      for (int16_t i = 0; i < w; i++)
+      {
+        if (i & 7)
+        {
+          b <<= 1;
+        }
+        else
+        {
+          b = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
+        }
+        if (b & 0x80)
+        {
+          drawPixel(x + i, y, color);
+        }
+      }
+    }
+  }
+
+  /* 以当前 GFXfont 绘制一个字符，(x, y) 为基线起点；不绘制背景 */
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                uint16_t bg, uint8_t size)
+  {
+    (void)bg;
+    if (gfxFont == NULL)
+    {
+      return; // 替身不含内置的 5x7 字体
+    }
+    c -= static_cast<uint8_t>(pgm_read_byte(&gfxFont->first));
+    const GFXglyph *glyph = &gfxFont->glyph[c];
+    const uint8_t *bitmap = gfxFont->bitmap;
+    uint16_t bo = glyph->bitmapOffset;
+    uint8_t w = glyph->width, h = glyph->height;
+    int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+    uint8_t bits = 0, bit = 0;
+    for (uint8_t yy = 0; yy < h; yy++)
+    {
+      for (uint8_t xx = 0; xx < w; xx++)
+      {
+        if (!(bit++ & 7))
+        {
+          bits = pgm_read_byte(&bitmap[bo++]);
+        }
+        if (bits & 0x80)
+        {
+          if (size == 1)
+          {
+            drawPixel(x + xo + xx, y + yo + yy, color);
+          }
+          else
+          {
+            fillRect(x + (xo + xx) * size, y + (yo + yy) * size,
+                     size, size, color);
+          }
+        }
+        bits <<= 1;
+      }
+    }
+  }
+
+  void setRotation(uint8_t r)
+  {
+    rotation = r & 3;
+    _width  = rotation & 1 ? HEIGHT : WIDTH;
+    _height = rotation & 1 ? WIDTH : HEIGHT;
+  }
+  uint8_t getRotation() const { return rotation; }
+  void setFont(const GFXfont *f) { gfxFont = const_cast<GFXfont *>(f); }
+  void setTextSize(uint8_t s) { textsize_x = textsize_y = s > 0 ? s : 1; }
+  void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+  void setTextColor(uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+  void setTextWrap(bool w) { wrap = w; }
+  void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  size_t write(uint8_t) override { return 1; }
+
+protected:
+  const int16_t WIDTH, HEIGHT;
+  int16_t _width, _height;
+  int16_t cursor_x = 0, cursor_y = 0;
+  uint16_t textcolor = 0xFFFF, textbgcolor = 0xFFFF;
+  uint8_t textsize_x = 1, textsize_y = 1;
+  uint8_t rotation = 0;
+  bool wrap = true;
+  GFXfont *gfxFont = NULL;
+};
+
+/* 1 位单色画布：color 非 0 的点置位 */
+class GFXcanvas1 : public Adafruit_GFX
+{
+public:
+  GFXcanvas1(uint16_t w, uint16_t h)
+    : Adafruit_GFX(w, h), buffer(static_cast<uint8_t *>(
+                            calloc(((w + 7) / 8) * h, 1))) {}
+  ~GFXcanvas1() { free(buffer); }
+  GFXcanvas1(const GFXcanvas1 &) = delete;
+  GFXcanvas1 &operator=(const GFXcanvas1 &) = delete;
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override
+  {
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+    {
+      return;
+    }
+    int16_t t;
+    switch (rotation)
+    {
+      case 1:
+        t = x;
+        x = WIDTH - 1 - y;
+        y = t;
+        break;
+      case 2:
+        x = WIDTH - 1 - x;
+        y = HEIGHT - 1 - y;
+        break;
+      case 3:
+        t = x;
+        x = y;
+        y = HEIGHT - 1 - t;
+        break;
+    }
+    uint8_t *ptr = &buffer[(x / 8) + y * ((WIDTH + 7) / 8)];
+    if (color)
+    {
+      *ptr |= 0x80 >> (x & 7);
+    }
+    else
+    {
+      *ptr &= ~(0x80 >> (x & 7));
+    }
+  }
+
+  bool getPixel(int16_t x, int16_t y) const
+  {
+    if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT)
+    {
+      return false;
+    }
+    return buffer[(x / 8) + y * ((WIDTH + 7) / 8)] & (0x80 >> (x & 7));
+  }
+
+  void fillScreen(uint16_t color) override
+  {
+    memset(buffer, color ? 0xFF : 0x00, ((WIDTH + 7) / 8) * HEIGHT);
+  }
+
+  uint8_t *getBuffer() const { return buffer; }
+
+private:
+  uint8_t *buffer;
+};
+
+#endif
@@ -0,0 +1,282 @@
+/* 主机（native 环境）上的 Arduino 核心替身
+ *
+ * 只实现 src/ 中参与主机测试的模块所用到的部分：String、Print/Stream、Serial、
+ * IPAddress、millis() 与若干 ESP32 宏。millis() 返回 fakeMillis，由测试设置；
+ * 网络测试将 realMillis 设为 true，改用真实时间（delay() 随之真正等待）。
+ */
+#ifndef __SHIM_ARDUINO_H__
+#define __SHIM_ARDUINO_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+#include <thread>
+#include <time.h>
+#include <freertos/FreeRTOS.h>
+
+#define PROGMEM
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+#define pgm_read_byte(addr)  (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr)  (*reinterpret_cast<const uint16_t *>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t *>(addr))
+#define pgm_read_ptr(addr)   (*reinterpret_cast<void * const *>(addr))
+
+#define log_e(...) (fprintf(stderr, __VA_ARGS__), fputc('\n', stderr))
+#define log_w(...) log_e(__VA_ARGS__)
+#define log_i(...)
+#define log_d(...)
+
+using std::max;
+using std::min;
+
+#define LOW  0
+#define HIGH 1
+#define INPUT  0x01
+#define OUTPUT 0x03
+#define LED_BUILTIN 2
+#define DEC 10
+#define HEX 16
+
+inline unsigned long fakeMillis = 0;
+inline bool realMillis = false;
+inline unsigned long millis()
+{
+  if (!realMillis)
+  {
+    return fakeMillis;
+  }
+  static const auto start = std::chrono::steady_clock::now();
+  return fakeMillis + std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+}
+inline void delay(unsigned long ms)
+{
+  if (realMillis)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+  else
+  {
+    fakeMillis += ms;
+  }
+}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline uint16_t analogRead(uint8_t) { return 0; }
+
+class String
+{
+public:
+  String(const char *s = "") : s_(s != NULL ? s : "") {}
+  String(const std::string &s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int v) : s_(std::to_string(v)) {}
+  explicit String(unsigned v) : s_(std::to_string(v)) {}
+  explicit String(long v) : s_(std::to_string(v)) {}
+  explicit String(unsigned long v) : s_(std::to_string(v)) {}
+  String(int v, unsigned char base)
+  {
+    char buf[34];
+    snprintf(buf, sizeof(buf), base == HEX ? "%x" : "%d", v);
+    s_ = buf;
+  }
+
+  const char *c_str() const { return s_.c_str(); }
+  unsigned length() const { return s_.length(); }
+  bool isEmpty() const { return s_.empty(); }
+  char operator[](unsigned i) const { return i < s_.size() ? s_[i] : 0; }
+
+  bool equals(const String &o) const { return s_ == o.s_; }
+  bool equalsIgnoreCase(const String &o) const
+  {
+    return s_.size() == o.s_.size() && strcasecmp(c_str(), o.c_str()) == 0;
+  }
+  bool startsWith(const String &o) const { return s_.rfind(o.s_, 0) == 0; }
+  int indexOf(char c, unsigned from = 0) const
+  {
+    size_t i = s_.find(c, from);
+    return i == std::string::npos ? -1 : static_cast<int>(i);
+  }
+  int indexOf(const String &o, unsigned from = 0) const
+  {
+    size_t i = s_.find(o.s_, from);
+    return i == std::string::npos ? -1 : static_cast<int>(i);
+  }
+  String substring(unsigned from, unsigned to = UINT32_MAX) const
+  {
+    from = std::min<unsigned>(from, s_.size());
+    to = std::min<unsigned>(to, s_.size());
+    return s_.substr(from, to > from ? to - from : 0);
+  }
+  void replace(const String &from, const String &to)
+  {
+    for (size_t i = 0; !from.s_.empty()
+         && (i = s_.find(from.s_, i)) != std::string::npos; i += to.s_.size())
+    {
+      s_.replace(i, from.s_.size(), to.s_);
+    }
+  }
+  long toInt() const { return strtol(c_str(), NULL, 10); }
+
+  String &operator+=(const String &o) { s_ += o.s_; return *this; }
+  String &operator+=(const char *o) { s_ += o; return *this; }
+  String &operator+=(char c) { s_ += c; return *this; }
+  friend String operator+(String a, const String &b) { return a += b; }
+  friend String operator+(String a, const char *b) { return a += b; }
+  friend String operator+(const char *a, const String &b)
+  {
+    return String(a) += b;
+  }
+  bool operator==(const String &o) const { return s_ == o.s_; }
+  bool operator!=(const String &o) const { return s_ != o.s_; }
+
+private:
+  std::string s_;
+};
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size)
+  {
+    size_t n = 0;
+    while (n < size && write(buf[n]) == 1)
+    {
+      ++n;
+    }
+    return n;
+  }
+  size_t print(const char *s)
+  {
+    return write(reinterpret_cast<const uint8_t *>(s), strlen(s));
+  }
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t println(const char *s = "") { return print(s) + print("\n"); }
+  size_t println(const String &s) { return println(s.c_str()); }
+  size_t print(const tm *timeInfo, const char *format = NULL)
+  {
+    char buf[64];
+    strftime(buf, sizeof(buf), format != NULL ? format : "%c", timeInfo);
+    return print(buf);
+  }
+  size_t println(const tm *timeInfo, const char *format = NULL)
+  {
+    return print(timeInfo, format) + print("\n");
+  }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+  {
+    char buf[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return n > 0 ? print(buf) : 0;
+  }
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+
+  // read() 返回 -1 时由 timedRead() 决定是否等待，默认不等待，即视为超时
+  size_t readBytes(char *buffer, size_t length)
+  {
+    size_t n = 0;
+    while (n < length)
+    {
+      int c = timedRead();
+      if (c < 0)
+      {
+        break;
+      }
+      buffer[n++] = static_cast<char>(c);
+    }
+    return n;
+  }
+  size_t readBytes(uint8_t *buffer, size_t length)
+  {
+    return readBytes(reinterpret_cast<char *>(buffer), length);
+  }
+
+protected:
+  virtual int timedRead() { return read(); }
+
+  unsigned long _timeout = 1000;
+};
+
+/* 串口输出写到标准输出 */
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long) {}
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  using Print::write;
+};
+
+inline HardwareSerial Serial;
+
+/* IPv4 地址，内部按网络字节序保存（与 lwIP 相同） */
+class IPAddress
+{
+public:
+  IPAddress() {}
+  IPAddress(uint32_t addr) : addr_(addr) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : addr_(a | (b << 8) | (c << 16) | (static_cast<uint32_t>(d) << 24)) {}
+
+  operator uint32_t() const { return addr_; }
+  uint8_t operator[](int i) const { return addr_ >> (8 * i); }
+  String toString() const
+  {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u",
+             (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+  }
+
+private:
+  uint32_t addr_ = 0;
+};
+
+/* 与 arduino-esp32 相同：系统时间已设置（晚于 2016 年）时取本地时间 */
+inline bool getLocalTime(tm *info, uint32_t ms = 5000)
+{
+  time_t now = time(NULL);
+  if (now < (2016 - 1970) * 365 * 24 * 3600L)
+  {
+    return false;
+  }
+  localtime_r(&now, info);
+  return true;
+}
+
+class EspClass
+{
+public:
+  uint32_t getHeapSize() { return 0; }
+  uint32_t getFreeHeap() { return 0; }
+  uint32_t getMinFreeHeap() { return 0; }
+  uint32_t getMaxAllocHeap() { return 0; }
+};
+
+inline EspClass ESP;
+
+#endif
@@ -0,0 +1,128 @@
+/* 主机上的 GxEPD2_BW.h 替身：内存中的黑白帧缓冲
+ *
+ * 与 GxEPD2_BW 的绘图接口相同，绘制到整帧的 GFXcanvas1（置位为黑色，可直接写成
+ * PBM），不连接面板：init()、display() 等不做任何事。primitives 统计渲染器调用的
+ * 图元数（文字、位图、边框），pixels 统计绘制的像素数。
+ */
+#ifndef __SHIM_GXEPD2_BW_H__
+#define __SHIM_GXEPD2_BW_H__
+
+#include <SPI.h>
+#include <Adafruit_GFX.h>
+
+// 颜色，与 GxEPD2.h 中的定义相同
+#define GxEPD_BLACK     0x0000
+#define GxEPD_WHITE     0xFFFF
+#define GxEPD_DARKGREY  0x7BEF
+#define GxEPD_LIGHTGREY 0xC618
+#define GxEPD_RED       0xF800
+#define GxEPD_YELLOW    0xFFE0
+#define GxEPD_ORANGE    0xFC00
+#define GxEPD_GREEN     0x07E0
+#define GxEPD_BLUE      0x001F
+
+// 面板驱动，只提供尺寸
+class GxEPD2_750_T7
+{
+public:
+  static const uint16_t WIDTH  = 800;
+  static const uint16_t HEIGHT = 480;
+  GxEPD2_750_T7(int16_t cs, int16_t dc, int16_t rst, int16_t busy) {}
+};
+
+class GxEPD2_750
+{
+public:
+  static const uint16_t WIDTH  = 640;
+  static const uint16_t HEIGHT = 384;
+  GxEPD2_750(int16_t cs, int16_t dc, int16_t rst, int16_t busy) {}
+};
+
+template <typename GxEPD2_Type, const uint16_t page_height>
+class GxEPD2_BW : public GFXcanvas1
+{
+public:
+  uint32_t primitives = 0;
+  uint32_t pixels     = 0;
+
+  GxEPD2_BW(GxEPD2_Type epd2)
+    : GFXcanvas1(GxEPD2_Type::WIDTH, GxEPD2_Type::HEIGHT) {}
+
+  void init(uint32_t serial_diag_bitrate, bool initial,
+            uint16_t reset_duration, bool pulldown_rst_mode) {}
+  void setFullWindow() {}
+  void setPartialWindow(int16_t x, int16_t y, int16_t w, int16_t h) {}
+  // 整帧都在内存中，只有一页
+  void firstPage() { fillScreen(GxEPD_WHITE); }
+  bool nextPage() { return false; }
+  uint16_t pageHeight() const { return page_height; }
+  void display(bool partial_update_mode = false) {}
+  void displayWindow(int16_t x, int16_t y, int16_t w, int16_t h) {}
+  void powerOff() {}
+  void hibernate() {}
+
+  void resetStats()
+  {
+    primitives = 0;
+    pixels = 0;
+  }
+
+  // 白色以外的颜色都绘制为黑色
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override
+  {
+    ++pixels;
+    GFXcanvas1::drawPixel(x, y, color != GxEPD_WHITE);
+  }
+  void fillScreen(uint16_t color) override
+  {
+    GFXcanvas1::fillScreen(color != GxEPD_WHITE);
+  }
+
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                uint16_t bg, uint8_t size)
+  {
+    ++primitives;
+    GFXcanvas1::drawChar(x, y, c, color, bg, size);
+  }
+  void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
+                  int16_t h, uint16_t color)
+  {
+    ++primitives;
+    GFXcanvas1::drawBitmap(x, y, bitmap, w, h, color);
+  }
+  void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+                     uint16_t color)
+  {
+    ++primitives;
+    GFXcanvas1::drawRoundRect(x, y, w, h, r, color);
+  }
+
+  /* 清零的点以 color 绘制（图标的格式），与 GxEPD2_BW::drawInvertedBitmap() 相同 */
+  void drawInvertedBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                          int16_t w, int16_t h, uint16_t color)
+  {
+    ++primitives;
+    int16_t byteWidth = (w + 7) / 8;
+    uint8_t byte = 0;
+    for (int16_t j = 0; j < h; j++)
+    {
+      for (int16_t i = 0; i < w; i++)
+      {
+        if (i & 7)
+        {
+          byte <<= 1;
+        }
+        else
+        {
+          byte = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
+        }
+        if (!(byte & 0x80))
+        {
+          drawPixel(x + i, y + j, color);
+        }
+      }
+    }
+  }
+};
+
+#endif
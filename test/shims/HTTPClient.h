@@ -0,0 +1,252 @@
+/* 主机上的 HTTPClient 替身
+ *
+ * 只实现 client_utils.cpp 用到的部分，连接复用、请求头与错误码的行为与
+ * arduino-esp32 的 HTTPClient 相同：
+ *   - useHTTP10() 同时关闭连接复用，须在其后调用 setReuse()；
+ *   - 复用时请求带 "Connection: keep-alive"，响应为 HTTP/1.0 或带
+ *     "Connection: close" 时 end() 断开连接；
+ *   - addHeader() 忽略 Connection、User-Agent 与 Host；
+ *   - end() 丢弃已到达的未读数据，连接可复用时保留。
+ * requestCount 统计发出的请求数，供测试计算重试次数。
+ */
+#ifndef __SHIM_HTTP_CLIENT_H__
+#define __SHIM_HTTP_CLIENT_H__
+
+#include <vector>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClient.h>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+typedef enum {
+  HTTP_CODE_OK                = 200,
+  HTTP_CODE_NOT_FOUND         = 404,
+  HTTP_CODE_REQUEST_TIMEOUT   = 408,
+  HTTP_CODE_TOO_MANY_REQUESTS = 429,
+  HTTP_CODE_SERVICE_UNAVAILABLE = 503
+} t_http_codes;
+
+class HTTPClient
+{
+public:
+  static inline unsigned requestCount = 0;
+
+  ~HTTPClient() { end(); }
+
+  bool begin(WiFiClient &client, const String &host, uint16_t port,
+             const String &uri)
+  {
+    client_ = &client;
+    host_ = host;
+    port_ = port;
+    uri_ = uri;
+    headers_ = "";
+    size_ = -1;
+    return true;
+  }
+
+  void useHTTP10(bool useHTTP10)
+  {
+    http10_ = useHTTP10;
+    reuse_ = !useHTTP10;
+  }
+  void setReuse(bool reuse) { reuse_ = reuse; }
+  void setConnectTimeout(int32_t ms) { connectTimeout_ = ms; }
+  void setTimeout(uint16_t ms) { timeout_ = ms; }
+
+  void addHeader(const String &name, const String &value)
+  {
+    if (name.equalsIgnoreCase("Connection")
+     || name.equalsIgnoreCase("User-Agent")
+     || name.equalsIgnoreCase("Host"))
+    {
+      return;
+    }
+    headers_ += name + ": " + value + "\r\n";
+  }
+
+  void collectHeaders(const char *keys[], size_t count)
+  {
+    collected_.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+      collected_.push_back({keys[i], ""});
+    }
+  }
+
+  String header(const char *name)
+  {
+    for (const auto &h : collected_)
+    {
+      if (h.first.equalsIgnoreCase(name))
+      {
+        return h.second;
+      }
+    }
+    return "";
+  }
+
+  int GET()
+  {
+    if (client_ == NULL)
+    {
+      return HTTPC_ERROR_NOT_CONNECTED;
+    }
+    if (!client_->connected())
+    {
+      IPAddress ip;
+      if (!WiFi.hostByName(host_.c_str(), ip)
+       || !client_->connect(ip, port_, connectTimeout_))
+      {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+      }
+    }
+    client_->setTimeout(timeout_);
+
+    String request = String("GET ") + uri_ + (http10_ ? " HTTP/1.0\r\n"
+                                                      : " HTTP/1.1\r\n");
+    request += "Host: " + host_;
+    if (port_ != 80 && port_ != 443)
+    {
+      request += ":" + String(static_cast<int>(port_), DEC);
+    }
+    request += "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: ";
+    request += reuse_ ? "keep-alive\r\n" : "close\r\n";
+    if (!http10_)
+    {
+      request += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+    }
+    request += headers_ + "\r\n";
+    ++requestCount;
+    if (client_->write(reinterpret_cast<const uint8_t *>(request.c_str()),
+                       request.length()) != request.length())
+    {
+      return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+    return handleHeaderResponse();
+  }
+
+  WiFiClient &getStream() { return *client_; }
+  int getSize() { return size_; }
+
+  void end()
+  {
+    if (client_ != NULL && client_->connected())
+    {
+      while (client_->available() > 0)
+      {
+        client_->read();
+      }
+      if (!(reuse_ && canReuse_))
+      {
+        client_->stop();
+      }
+    }
+  }
+
+private:
+  /* 读取一行（去掉行尾的 "\r\n"），超时或连接断开返回false */
+  bool readLine(String &line)
+  {
+    line = "";
+    for (;;)
+    {
+      char c;
+      if (client_->readBytes(&c, 1) != 1)
+      {
+        return false;
+      }
+      if (c == '\n')
+      {
+        return true;
+      }
+      if (c != '\r')
+      {
+        line += c;
+      }
+    }
+  }
+
+  int handleHeaderResponse()
+  {
+    canReuse_ = reuse_;
+    size_ = -1;
+    for (auto &h : collected_)
+    {
+      h.second = "";
+    }
+    int code = 0;
+    String line;
+    for (;;)
+    {
+      if (!readLine(line))
+      {
+        return client_->connected() ? HTTPC_ERROR_READ_TIMEOUT
+                                    : HTTPC_ERROR_CONNECTION_LOST;
+      }
+      if (line.isEmpty())
+      {
+        return code > 0 ? code : HTTPC_ERROR_NO_HTTP_SERVER;
+      }
+      if (line.startsWith("HTTP/1."))
+      {
+        canReuse_ = canReuse_ && line[7] != '0';
+        code = line.substring(9, 12).toInt();
+        continue;
+      }
+      int colon = line.indexOf(':');
+      if (colon <= 0)
+      {
+        continue;
+      }
+      String name = line.substring(0, colon);
+      String value = line.substring(colon + 1);
+      while (value[0] == ' ')
+      {
+        value = value.substring(1);
+      }
+      if (name.equalsIgnoreCase("Content-Length"))
+      {
+        size_ = value.toInt();
+      }
+      else if (name.equalsIgnoreCase("Connection")
+            && value.indexOf("close") >= 0 && value.indexOf("keep-alive") < 0)
+      {
+        canReuse_ = false;
+      }
+      for (auto &h : collected_)
+      {
+        if (h.first.equalsIgnoreCase(name))
+        {
+          h.second = value;
+        }
+      }
+    }
+  }
+
+  WiFiClient *client_ = NULL;
+  String host_;
+  uint16_t port_ = 80;
+  String uri_;
+  String headers_;
+  std::vector<std::pair<String, String>> collected_;
+  bool http10_ = false;
+  bool reuse_ = true;
+  bool canReuse_ = false;
+  int32_t connectTimeout_ = 5000;
+  uint16_t timeout_ = 5000;
+  int size_ = -1;
+};
+
+#endif
@@ -0,0 +1,30 @@
+/* 测试用的内存流：从一段字节中读取，可限制每次 available() 报告的字节数，
+ * 模拟数据分段到达；读完后 read() 返回 -1，相当于底层连接超时或关闭。
+ */
+#ifndef __SHIM_MEMORY_STREAM_H__
+#define __SHIM_MEMORY_STREAM_H__
+
+#include <Arduino.h>
+
+class MemoryStream : public Stream
+{
+public:
+  MemoryStream(const void *data, size_t len, size_t chunk = SIZE_MAX)
+    : data_(static_cast<const uint8_t *>(data)), len_(len), chunk_(chunk) {}
+  explicit MemoryStream(const char *s) : MemoryStream(s, strlen(s)) {}
+
+  size_t position() const { return pos_; }
+
+  int available() override { return std::min(len_ - pos_, chunk_); }
+  int read() override { return pos_ < len_ ? data_[pos_++] : -1; }
+  int peek() override { return pos_ < len_ ? data_[pos_] : -1; }
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  const uint8_t *data_;
+  size_t len_;
+  size_t chunk_;
+  size_t pos_ = 0;
+};
+
+#endif
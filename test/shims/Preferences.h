@@ -0,0 +1,111 @@
+/* 主机上的 Preferences 替身：键值保存在内存中，进程结束即丢失
+ *
+ * 测试可调用 Preferences::clearAll() 模拟擦除 NVS。
+ */
+#ifndef __SHIM_PREFERENCES_H__
+#define __SHIM_PREFERENCES_H__
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+
+class Preferences
+{
+public:
+  bool begin(const char *name, bool readOnly = false)
+  {
+    ns_ = name;
+    readOnly_ = readOnly;
+    return true;
+  }
+  void end() {}
+  bool clear()
+  {
+    store().erase(ns_);
+    return true;
+  }
+  bool isKey(const char *key) { return find(key) != NULL; }
+  bool remove(const char *key) { return store()[ns_].erase(key) > 0; }
+
+  float getFloat(const char *key, float def = 0) { return get(key, def); }
+  size_t putFloat(const char *key, float v) { return put(key, v); }
+  uint8_t getUChar(const char *key, uint8_t def = 0) { return get(key, def); }
+  size_t putUChar(const char *key, uint8_t v) { return put(key, v); }
+  uint32_t getUInt(const char *key, uint32_t def = 0) { return get(key, def); }
+  size_t putUInt(const char *key, uint32_t v) { return put(key, v); }
+  int32_t getInt(const char *key, int32_t def = 0) { return get(key, def); }
+  size_t putInt(const char *key, int32_t v) { return put(key, v); }
+  uint64_t getULong64(const char *key, uint64_t def = 0)
+  {
+    return get(key, def);
+  }
+  size_t putULong64(const char *key, uint64_t v) { return put(key, v); }
+  bool getBool(const char *key, bool def = false) { return get(key, def); }
+  size_t putBool(const char *key, bool v) { return put(key, v); }
+
+  size_t getBytesLength(const char *key)
+  {
+    const std::vector<uint8_t> *v = find(key);
+    return v != NULL ? v->size() : 0;
+  }
+  size_t getBytes(const char *key, void *buf, size_t len)
+  {
+    const std::vector<uint8_t> *v = find(key);
+    if (v == NULL || v->size() > len)
+    {
+      return 0;
+    }
+    memcpy(buf, v->data(), v->size());
+    return v->size();
+  }
+  size_t putBytes(const char *key, const void *buf, size_t len)
+  {
+    if (readOnly_)
+    {
+      return 0;
+    }
+    const uint8_t *p = static_cast<const uint8_t *>(buf);
+    store()[ns_][key].assign(p, p + len);
+    return len;
+  }
+
+  static void clearAll() { store().clear(); }
+
+private:
+  typedef std::map<std::string, std::vector<uint8_t>> ns_t;
+
+  static std::map<std::string, ns_t> &store()
+  {
+    static std::map<std::string, ns_t> s;
+    return s;
+  }
+
+  const std::vector<uint8_t> *find(const char *key)
+  {
+    auto ns = store().find(ns_);
+    if (ns == store().end())
+    {
+      return NULL;
+    }
+    auto it = ns->second.find(key);
+    return it != ns->second.end() ? &it->second : NULL;
+  }
+
+  template <typename T> T get(const char *key, T def)
+  {
+    T v;
+    return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : def;
+  }
+
+  template <typename T> size_t put(const char *key, T v)
+  {
+    return putBytes(key, &v, sizeof(v));
+  }
+
+  std::string ns_;
+  bool readOnly_ = false;
+};
+
+#endif
@@ -0,0 +1,17 @@
+/* 主机上的 SPI.h 替身：主机上没有 SPI 总线，begin()/end() 不做任何事 */
+#ifndef __SHIM_SPI_H__
+#define __SHIM_SPI_H__
+
+#include <Arduino.h>
+
+class SPIClass
+{
+public:
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1,
+             int8_t ss = -1) {}
+  void end() {}
+};
+
+inline SPIClass SPI;
+
+#endif
@@ -0,0 +1,94 @@
+/* 主机上的 WiFi.h 替身
+ *
+ * 连接状态由 WiFi.fakeStatus 决定（默认已连接），begin() 时据此触发 GOT_IP 事件。
+ * 所有域名都解析为本机地址，网络测试连接的是本机的模拟服务器。
+ */
+#ifndef __SHIM_WIFI_H__
+#define __SHIM_WIFI_H__
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+typedef enum {
+  WL_NO_SHIELD       = 255,
+  WL_IDLE_STATUS     = 0,
+  WL_NO_SSID_AVAIL   = 1,
+  WL_SCAN_COMPLETED  = 2,
+  WL_CONNECTED       = 3,
+  WL_CONNECT_FAILED  = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED    = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1
+} wifi_mode_t;
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP
+} arduino_event_id_t;
+
+typedef struct {} arduino_event_info_t;
+
+typedef void (*WiFiEventFuncCb)(arduino_event_id_t event,
+                                arduino_event_info_t info);
+
+class WiFiClass
+{
+public:
+  wl_status_t fakeStatus = WL_CONNECTED;
+
+  wl_status_t status() { return fakeStatus; }
+  void onEvent(WiFiEventFuncCb cb) { cb_ = cb; }
+  bool mode(wifi_mode_t) { return true; }
+  bool config(IPAddress, IPAddress, IPAddress,
+              IPAddress = IPAddress(), IPAddress = IPAddress())
+  {
+    return true;
+  }
+  wl_status_t begin(const char *, const char *, int32_t = 0,
+                    const uint8_t * = NULL)
+  {
+    if (cb_ != NULL && fakeStatus == WL_CONNECTED)
+    {
+      cb_(ARDUINO_EVENT_WIFI_STA_GOT_IP, arduino_event_info_t());
+    }
+    return fakeStatus;
+  }
+  bool disconnect()
+  {
+    if (cb_ != NULL)
+    {
+      cb_(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, arduino_event_info_t());
+    }
+    return true;
+  }
+
+  uint8_t *BSSID()
+  {
+    static uint8_t bssid[6] = {};
+    return bssid;
+  }
+  int32_t channel() { return 1; }
+  int8_t RSSI() { return -50; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+  IPAddress dnsIP(uint8_t = 0) { return IPAddress(127, 0, 0, 1); }
+
+  int hostByName(const char *, IPAddress &ip)
+  {
+    ip = IPAddress(127, 0, 0, 1);
+    return 1;
+  }
+
+private:
+  WiFiEventFuncCb cb_ = NULL;
+};
+
+inline WiFiClass WiFi;
+
+#endif
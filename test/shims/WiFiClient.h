@@ -0,0 +1,165 @@
+/* 主机上的 WiFiClient 替身：系统的 TCP 套接字
+ *
+ * 与 arduino-esp32 相同，read() 在没有数据时立即返回 -1，readBytes() 等待至
+ * setTimeout() 设定的超时。主机测试可将 redirectPort 设为模拟服务器的端口，
+ * 此后所有连接都转到该端口；connectCount 统计建立的连接数。
+ */
+#ifndef __SHIM_WIFI_CLIENT_H__
+#define __SHIM_WIFI_CLIENT_H__
+
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <Arduino.h>
+
+#ifndef MSG_NOSIGNAL
+  #define MSG_NOSIGNAL 0
+#endif
+
+class WiFiClient : public Stream
+{
+public:
+  // 非 0 时所有连接都转到此端口（本机的模拟服务器）
+  static inline uint16_t redirectPort = 0;
+  static inline unsigned connectCount = 0;
+
+  WiFiClient() {}
+  WiFiClient(const WiFiClient &) = delete;
+  WiFiClient &operator=(const WiFiClient &) = delete;
+  ~WiFiClient() { stop(); }
+
+  int connect(IPAddress ip, uint16_t port, int32_t timeoutMs)
+  {
+    stop();
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd_ < 0)
+    {
+      return 0;
+    }
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(redirectPort != 0 ? redirectPort : port);
+    addr.sin_addr.s_addr = static_cast<uint32_t>(ip);
+    // 非阻塞连接，按超时等待完成
+    int flags = fcntl(fd_, F_GETFL, 0);
+    fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+    int ret = ::connect(fd_, reinterpret_cast<sockaddr *>(&addr),
+                        sizeof(addr));
+    if (ret < 0 && errno == EINPROGRESS)
+    {
+      pollfd p = {fd_, POLLOUT, 0};
+      int err = 0;
+      socklen_t len = sizeof(err);
+      ret = poll(&p, 1, timeoutMs) == 1
+            && getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &len) == 0
+            && err == 0 ? 0 : -1;
+    }
+    if (ret < 0)
+    {
+      stop();
+      return 0;
+    }
+    fcntl(fd_, F_SETFL, flags);
+    ++connectCount;
+    return 1;
+  }
+  int connect(IPAddress ip, uint16_t port) { return connect(ip, port, 3000); }
+
+  /* 连接仍然打开（或仍有未读数据）返回非 0 */
+  uint8_t connected()
+  {
+    if (fd_ < 0)
+    {
+      return 0;
+    }
+    uint8_t c;
+    ssize_t n = recv(fd_, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)))
+    {
+      return 1;
+    }
+    stop(); // 对方已关闭或出错
+    return 0;
+  }
+
+  void stop()
+  {
+    if (fd_ >= 0)
+    {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  int available() override
+  {
+    int n = 0;
+    return fd_ >= 0 && ioctl(fd_, FIONREAD, &n) == 0 ? n : 0;
+  }
+
+  int read() override
+  {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+
+  int read(uint8_t *buf, size_t size)
+  {
+    if (fd_ < 0)
+    {
+      return -1;
+    }
+    ssize_t n = recv(fd_, buf, size, MSG_DONTWAIT);
+    return n > 0 ? static_cast<int>(n) : -1;
+  }
+
+  int peek() override
+  {
+    uint8_t c;
+    return fd_ >= 0 && recv(fd_, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+  }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override
+  {
+    size_t sent = 0;
+    while (fd_ >= 0 && sent < size)
+    {
+      ssize_t n = send(fd_, buf + sent, size - sent, MSG_NOSIGNAL);
+      if (n <= 0)
+      {
+        break;
+      }
+      sent += n;
+    }
+    return sent;
+  }
+  using Print::write;
+
+protected:
+  /* 等待数据到达，至多 _timeout 毫秒 */
+  int timedRead() override
+  {
+    int c = read();
+    if (c >= 0 || fd_ < 0)
+    {
+      return c;
+    }
+    pollfd p = {fd_, POLLIN, 0};
+    return poll(&p, 1, static_cast<int>(_timeout)) == 1 ? read() : -1;
+  }
+
+private:
+  int fd_ = -1;
+};
+
+#endif
@@ -0,0 +1,12 @@
+/* 主机上的 driver/adc.h 替身 */
+#ifndef __SHIM_DRIVER_ADC_H__
+#define __SHIM_DRIVER_ADC_H__
+
+typedef enum { ADC_UNIT_1 = 1, ADC_UNIT_2 = 2 } adc_unit_t;
+typedef enum { ADC_ATTEN_DB_11 = 3, ADC_ATTEN_11db = ADC_ATTEN_DB_11 } adc_atten_t;
+typedef enum { ADC_WIDTH_BIT_12 = 3 } adc_bits_width_t;
+
+inline void adc_power_acquire() {}
+inline void adc_power_release() {}
+
+#endif
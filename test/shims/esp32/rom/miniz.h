@@ -0,0 +1,91 @@
+/* 主机上的 ROM miniz 替身：tinfl 接口的子集，由系统的 zlib 实现
+ *
+ * 只支持 InflateStream 的用法（TINFL_LZ_DICT_SIZE 的环形输出字典），并检查
+ * tinfl 对环形字典的要求：大小为 2 的幂，输出位置紧接上次输出之后。zlib 自己
+ * 保存回溯窗口，不会读取字典，因此字典在下一次调用前被改写也不会暴露出来。
+ * 链接时需要 -lz。
+ */
+#ifndef __SHIM_ESP32_ROM_MINIZ_H__
+#define __SHIM_ESP32_ROM_MINIZ_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+  TINFL_FLAG_PARSE_ZLIB_HEADER             = 1,
+  TINFL_FLAG_HAS_MORE_INPUT                = 2,
+  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+  TINFL_FLAG_COMPUTE_ADLER32               = 8
+};
+
+typedef enum {
+  TINFL_STATUS_BAD_PARAM         = -3,
+  TINFL_STATUS_ADLER32_MISMATCH  = -2,
+  TINFL_STATUS_FAILED            = -1,
+  TINFL_STATUS_DONE              = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT  = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT   = 2
+} tinfl_status;
+
+typedef struct {
+  z_stream z;
+  bool     started;
+} tinfl_decompressor;
+
+inline void tinfl_init(tinfl_decompressor *r)
+{
+  if (r->started)
+  {
+    inflateEnd(&r->z);
+  }
+  *r = {};
+}
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor *r,
+                                     const uint8_t *pIn_buf_next,
+                                     size_t *pIn_buf_size,
+                                     uint8_t *pOut_buf_start,
+                                     uint8_t *pOut_buf_next,
+                                     size_t *pOut_buf_size,
+                                     const uint32_t decomp_flags)
+{
+  size_t dictSize = (pOut_buf_next - pOut_buf_start) + *pOut_buf_size;
+  if (!(decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF)
+   && ((dictSize & (dictSize - 1)) != 0 || pOut_buf_next < pOut_buf_start
+    || static_cast<size_t>(pOut_buf_next - pOut_buf_start)
+       != (r->started ? r->z.total_out : 0) % dictSize))
+  {
+    return TINFL_STATUS_BAD_PARAM;
+  }
+  if (!r->started)
+  { // 负的窗口位数表示原始 deflate，不解析 zlib 头
+    int windowBits = decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER ? 15 : -15;
+    if (inflateInit2(&r->z, windowBits) != Z_OK)
+    {
+      return TINFL_STATUS_FAILED;
+    }
+    r->started = true;
+  }
+  r->z.next_in   = const_cast<Bytef *>(pIn_buf_next);
+  r->z.avail_in  = *pIn_buf_size;
+  r->z.next_out  = pOut_buf_next;
+  r->z.avail_out = *pOut_buf_size;
+  int ret = inflate(&r->z, Z_NO_FLUSH);
+  *pIn_buf_size  -= r->z.avail_in;
+  *pOut_buf_size -= r->z.avail_out;
+  if (ret == Z_STREAM_END)
+  {
+    return TINFL_STATUS_DONE;
+  }
+  if (ret != Z_OK && ret != Z_BUF_ERROR)
+  {
+    return TINFL_STATUS_FAILED;
+  }
+  return r->z.avail_out == 0 ? TINFL_STATUS_HAS_MORE_OUTPUT
+                             : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
+
+#endif
@@ -0,0 +1,32 @@
+/* 主机上的 esp_adc_cal.h 替身：原始读数按 1:1 换算为毫伏 */
+#ifndef __SHIM_ESP_ADC_CAL_H__
+#define __SHIM_ESP_ADC_CAL_H__
+
+#include <cstdint>
+#include <driver/adc.h>
+
+typedef enum {
+  ESP_ADC_CAL_VAL_EFUSE_VREF,
+  ESP_ADC_CAL_VAL_EFUSE_TP,
+  ESP_ADC_CAL_VAL_DEFAULT_VREF
+} esp_adc_cal_value_t;
+
+typedef struct {
+  uint32_t vref;
+} esp_adc_cal_characteristics_t;
+
+inline esp_adc_cal_value_t esp_adc_cal_characterize(
+  adc_unit_t, adc_atten_t, adc_bits_width_t, uint32_t vref,
+  esp_adc_cal_characteristics_t *chars)
+{
+  chars->vref = vref;
+  return ESP_ADC_CAL_VAL_DEFAULT_VREF;
+}
+
+inline uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw,
+                                           const esp_adc_cal_characteristics_t *)
+{
+  return raw;
+}
+
+#endif
@@ -0,0 +1,22 @@
+/* 主机上的 esp_sleep.h 替身：唤醒原因由测试设置 */
+#ifndef __SHIM_ESP_SLEEP_H__
+#define __SHIM_ESP_SLEEP_H__
+
+#include <cstdint>
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+} esp_sleep_wakeup_cause_t;
+
+inline esp_sleep_wakeup_cause_t fakeWakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause()
+{
+  return fakeWakeupCause;
+}
+
+#endif
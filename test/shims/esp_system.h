@@ -0,0 +1,14 @@
+/* 主机上的 esp_system.h 替身：随机数序列固定，便于复现 */
+#ifndef __SHIM_ESP_SYSTEM_H__
+#define __SHIM_ESP_SYSTEM_H__
+
+#include <cstdint>
+#include <random>
+
+inline uint32_t esp_random()
+{
+  static std::mt19937 rng(12345);
+  return rng();
+}
+
+#endif
@@ -0,0 +1,14 @@
+/* 主机上的 esp_timer.h 替身：单调时钟，单位为微秒 */
+#ifndef __SHIM_ESP_TIMER_H__
+#define __SHIM_ESP_TIMER_H__
+
+#include <chrono>
+#include <cstdint>
+
+inline int64_t esp_timer_get_time()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
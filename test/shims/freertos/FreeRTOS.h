@@ -0,0 +1,26 @@
+/* 主机上的 FreeRTOS 替身：节拍为 1 毫秒，临界区由互斥锁实现 */
+#ifndef __SHIM_FREERTOS_H__
+#define __SHIM_FREERTOS_H__
+
+#include <cstdint>
+#include <mutex>
+
+typedef uint32_t TickType_t;
+typedef int32_t  BaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+#define portMAX_DELAY     UINT32_MAX
+
+#define BIT0 (1U << 0)
+#define BIT1 (1U << 1)
+#define BIT2 (1U << 2)
+#define BIT3 (1U << 3)
+
+typedef std::recursive_mutex portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) ((mux)->lock())
+#define portEXIT_CRITICAL(mux)  ((mux)->unlock())
+
+#endif
@@ -0,0 +1,62 @@
+/* 主机上的 FreeRTOS 事件组替身 */
+#ifndef __SHIM_FREERTOS_EVENT_GROUPS_H__
+#define __SHIM_FREERTOS_EVENT_GROUPS_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <freertos/FreeRTOS.h>
+
+typedef uint32_t EventBits_t;
+
+struct shim_event_group_t
+{
+  std::mutex              mutex;
+  std::condition_variable changed;
+  EventBits_t             bits = 0;
+};
+typedef shim_event_group_t *EventGroupHandle_t;
+
+inline EventGroupHandle_t xEventGroupCreate()
+{
+  return new shim_event_group_t;
+}
+
+inline EventBits_t xEventGroupSetBits(EventGroupHandle_t group,
+                                      EventBits_t bits)
+{
+  std::lock_guard<std::mutex> lock(group->mutex);
+  group->bits |= bits;
+  group->changed.notify_all();
+  return group->bits;
+}
+
+inline EventBits_t xEventGroupClearBits(EventGroupHandle_t group,
+                                        EventBits_t bits)
+{
+  std::lock_guard<std::mutex> lock(group->mutex);
+  EventBits_t old = group->bits;
+  group->bits &= ~bits;
+  return old;
+}
+
+inline EventBits_t xEventGroupWaitBits(EventGroupHandle_t group,
+                                       EventBits_t bits, BaseType_t clear,
+                                       BaseType_t waitForAll,
+                                       TickType_t ticks)
+{
+  std::unique_lock<std::mutex> lock(group->mutex);
+  auto ready = [&] {
+    EventBits_t set = group->bits & bits;
+    return waitForAll ? set == bits : set != 0;
+  };
+  group->changed.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+  EventBits_t result = group->bits;
+  if (clear && ready())
+  {
+    group->bits &= ~bits;
+  }
+  return result;
+}
+
+#endif
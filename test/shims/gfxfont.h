@@ -0,0 +1,21 @@
+/* 主机上的 gfxfont.h 替身，结构与 Adafruit GFX Library 中的定义相同 */
+#ifndef __SHIM_GFXFONT_H__
+#define __SHIM_GFXFONT_H__
+
+#include <cstdint>
+
+typedef struct {
+  uint16_t bitmapOffset;
+  uint8_t  width, height;
+  uint8_t  xAdvance;
+  int8_t   xOffset, yOffset;
+} GFXglyph;
+
+typedef struct {
+  uint8_t  *bitmap;
+  GFXglyph *glyph;
+  uint16_t  first, last;
+  uint8_t   yAdvance;
+} GFXfont;
+
+#endif
@@ -0,0 +1,11 @@
+/* 主机上的 lwIP 套接字接口替身，直接使用系统的 BSD 套接字 */
+#ifndef __SHIM_LWIP_SOCKETS_H__
+#define __SHIM_LWIP_SOCKETS_H__
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif
@@ -0,0 +1,210 @@
+/* deserializeCMAWeather() 的主机测试：按中国气象台接口的响应格式解析
+ *
+ * test_throughput 输出静态区峰值、解析期间的堆分配与解析速度（加 -v 可见）。
+ * 运行：pio test -e native -f test_api_response
+ */
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <unity.h>
+#include <MemoryStream.h>
+
+#include "api_response.h"
+
+// 正常响应（cn.apihz.cn/api/tianqi/tqyb.php 的返回格式，含过滤器丢弃的字段）
+static const char CMA_RESPONSE[] =
+  "{\"precipitation\":0,\"temperature\":26.5,\"pressure\":1006,"
+  "\"humidity\":60,\"windDirection\":\"东南风\",\"windDirectionDegree\":138,"
+  "\"windSpeed\":2.4,\"windScale\":\"微风\",\"place\":\"中国, 北京, 北京\","
+  "\"weather1\":\"多云\",\"weather2\":\"晴\","
+  "\"weather1img\":\"https://rescdn.apihz.cn/resimg/tianqi/duoyun.png\","
+  "\"weather2img\":\"https://rescdn.apihz.cn/resimg/tianqi/qing.png\","
+  "\"uptime\":\"2024/06/28 16:40\",\"jieqi\":\"\",\"code\":200}";
+
+// 参数错误时的响应
+static const char CMA_ERROR[] =
+  "{\"code\":400,\"msg\":\"通讯秘钥错误。\"}";
+
+static const size_t JSON_ARENA_SIZE = 4096; // 与 api_response.cpp 相同
+
+// 统计堆分配，用于确认解析只使用静态区
+static size_t heapAllocs = 0;
+static size_t heapBytes = 0;
+
+void *operator new(size_t size)
+{
+  ++heapAllocs;
+  heapBytes += size;
+  void *p = malloc(size != 0 ? size : 1);
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+void setUp() {}
+void tearDown() {}
+
+static DeserializationError parse(const char *json, cma_weather_t &w)
+{
+  MemoryStream s(json);
+  return deserializeCMAWeather(s, w);
+}
+
+static void test_parse_response()
+{
+  cma_weather_t w;
+  TEST_ASSERT_TRUE(parse(CMA_RESPONSE, w) == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL_INT32(200, w.code);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 26.5f, w.temperature);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, w.precipitation);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.4f, w.windSpeed);
+  TEST_ASSERT_EQUAL_UINT8(60, w.humidity);
+  TEST_ASSERT_EQUAL_INT16(138, w.windDirectionDegree);
+  TEST_ASSERT_EQUAL(WIND_DIR_SE, w.windDir);
+  TEST_ASSERT_EQUAL_UINT8(2, w.windScaleLevel);
+  TEST_ASSERT_EQUAL_STRING("东南风", w.windDirection);
+  TEST_ASSERT_EQUAL_STRING("微风", w.windScale);
+  TEST_ASSERT_EQUAL_STRING("中国, 北京, 北京", w.place);
+  TEST_ASSERT_EQUAL_STRING("多云", w.weather1);
+  TEST_ASSERT_EQUAL(WX_CLOUDY, w.weather1Code);
+  TEST_ASSERT_EQUAL(WX_SUNNY, w.weather2Code);
+  TEST_ASSERT_EQUAL_STRING("", w.message);
+  TEST_MESSAGE(("静态区峰值 " + std::to_string(getJsonArenaPeak()) + "/"
+                + std::to_string(JSON_ARENA_SIZE) + " 字节").c_str());
+}
+
+/* 没有风向角度时由风向文字推算 */
+static void test_parse_degree_from_text()
+{
+  cma_weather_t w;
+  TEST_ASSERT_TRUE(parse("{\"code\":200,\"windDirection\":\"东北风\","
+                         "\"windScale\":\"3-4级\"}", w)
+                   == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL_INT16(45, w.windDirectionDegree);
+  TEST_ASSERT_EQUAL(WIND_DIR_NE, w.windDir);
+  TEST_ASSERT_EQUAL_UINT8(4, w.windScaleLevel);
+  TEST_ASSERT_EQUAL(WX_UNKNOWN, w.weather1Code);
+
+  TEST_ASSERT_TRUE(parse("{\"code\":200,\"windDirection\":\"无持续风向\"}", w)
+                   == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL_INT16(-1, w.windDirectionDegree);
+  TEST_ASSERT_EQUAL(WIND_DIR_UNKNOWN, w.windDir);
+  TEST_ASSERT_EQUAL_UINT8(WIND_SCALE_UNKNOWN, w.windScaleLevel);
+}
+
+static void test_parse_error_response()
+{
+  cma_weather_t w;
+  TEST_ASSERT_TRUE(parse(CMA_ERROR, w) == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL_INT32(400, w.code);
+  TEST_ASSERT_EQUAL_STRING("通讯秘钥错误。", w.message);
+  TEST_ASSERT_EQUAL_STRING("", w.place);
+}
+
+/* 超长文字在 UTF-8 字符边界截断，剩余字节补零 */
+static void test_truncate_utf8()
+{
+  std::string place;
+  for (int i = 0; i < 30; ++i)
+  {
+    place += "京";
+  }
+  std::string json = "{\"code\":200,\"place\":\"" + place + "\"}";
+  cma_weather_t w;
+  TEST_ASSERT_TRUE(parse(json.c_str(), w) == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL_size_t(63, strlen(w.place)); // 21 个汉字
+  TEST_ASSERT_EQUAL_MEMORY(place.data(), w.place, 63);
+  TEST_ASSERT_EQUAL_UINT8(0, w.place[sizeof(w.place) - 1]);
+}
+
+/* 截断的响应体 */
+static void test_truncated_body()
+{
+  std::string json(CMA_RESPONSE, sizeof(CMA_RESPONSE) / 2);
+  cma_weather_t w;
+  TEST_ASSERT_TRUE(parse(json.c_str(), w)
+                   == DeserializationError::IncompleteInput);
+}
+
+/* 远大于静态区的响应：不需要的字段边读边丢弃，不会耗尽静态区 */
+static void test_oversized_response()
+{
+  std::string json = "{\"code\":200,\"hourly\":[";
+  for (int i = 0; i < 500; ++i)
+  {
+    json += (i == 0 ? "" : ",");
+    json += "{\"time\":\"2024/06/28 " + std::to_string(i % 24)
+          + ":00\",\"temperature\":26.5,\"weather\":\"雷阵雨伴有冰雹\"}";
+  }
+  json += "],\"temperature\":-3.5,\"weather1\":\"小到中雪\"}";
+  TEST_ASSERT_GREATER_THAN(8 * JSON_ARENA_SIZE, json.size());
+
+  cma_weather_t w;
+  TEST_ASSERT_TRUE(parse(json.c_str(), w) == DeserializationError::Ok);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, -3.5f, w.temperature);
+  TEST_ASSERT_EQUAL(WX_LIGHT_TO_MODERATE_SNOW, w.weather1Code);
+  TEST_ASSERT_LESS_OR_EQUAL(JSON_ARENA_SIZE, getJsonArenaPeak());
+  TEST_MESSAGE(("响应 " + std::to_string(json.size()) + " 字节，静态区峰值 "
+                + std::to_string(getJsonArenaPeak()) + " 字节").c_str());
+}
+
+/* 解析速度与内存：静态区峰值不超过上限，解析期间不使用堆 */
+static void test_throughput()
+{
+  std::string big = "{\"code\":200,\"hourly\":[";
+  for (int i = 0; i < 500; ++i)
+  {
+    big += (i == 0 ? "" : ",");
+    big += "{\"time\":\"" + std::to_string(i % 24)
+         + ":00\",\"temperature\":26.5,\"weather\":\"多云\"}";
+  }
+  big += "],\"temperature\":26.5}";
+
+  const char *inputs[] = {CMA_RESPONSE, big.c_str()};
+  const char *names[] = {"正常响应", "超大响应"};
+  for (int i = 0; i < 2; ++i)
+  {
+    const int runs = 200;
+    size_t len = strlen(inputs[i]);
+    cma_weather_t w;
+    heapAllocs = 0;
+    heapBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < runs; ++n)
+    {
+      TEST_ASSERT_TRUE(parse(inputs[i], w) == DeserializationError::Ok);
+    }
+    double us = std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - start).count() / runs;
+    size_t allocs = heapAllocs;
+    TEST_ASSERT_EQUAL_size_t(0, allocs);
+    TEST_ASSERT_LESS_OR_EQUAL(JSON_ARENA_SIZE, getJsonArenaPeak());
+
+    char msg[160];
+    snprintf(msg, sizeof(msg),
+             "%s %zu 字节：%.1f 微秒/次，%.1f MB/s，静态区峰值 %zu 字节，"
+             "堆分配 %zu 次（%zu 字节）",
+             names[i], len, us, len / us, getJsonArenaPeak(), allocs,
+             heapBytes);
+    TEST_MESSAGE(msg);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_response);
+  RUN_TEST(test_parse_degree_from_text);
+  RUN_TEST(test_parse_error_response);
+  RUN_TEST(test_truncate_utf8);
+  RUN_TEST(test_truncated_body);
+  RUN_TEST(test_oversized_response);
+  RUN_TEST(test_throughput);
+  return UNITY_END();
+}
@@ -0,0 +1,116 @@
+/* 中国气象台风向、风力与天气现象编码的主机测试
+ *
+ * 运行：pio test -e native -f test_cma_codes
+ */
+#include <unity.h>
+
+#include "cma_codes.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_utf8_next()
+{
+  const char *p = "a北\xF0\x9F\x8C\xA7";
+  TEST_ASSERT_EQUAL_HEX32('a', utf8Next(p));
+  TEST_ASSERT_EQUAL_HEX32(0x5317, utf8Next(p));
+  TEST_ASSERT_EQUAL_HEX32(0x1F327, utf8Next(p));
+  TEST_ASSERT_EQUAL_HEX32(0, utf8Next(p));
+  TEST_ASSERT_EQUAL_HEX32(0, utf8Next(p)); // 结尾处不再前移
+}
+
+/* 无效字节返回 U+FFFD，截断的序列不越过结尾 */
+static void test_utf8_invalid()
+{
+  const char *p = "\x80" "a";
+  TEST_ASSERT_EQUAL_HEX32(0xFFFD, utf8Next(p));
+  TEST_ASSERT_EQUAL_HEX32('a', utf8Next(p));
+
+  const char *s = "\xE5\x8C";
+  p = s;
+  TEST_ASSERT_EQUAL_HEX32(0xFFFD, utf8Next(p));
+  TEST_ASSERT_TRUE(p <= s + 2);
+  TEST_ASSERT_EQUAL_HEX32(0, utf8Next(p));
+}
+
+static void test_wind_degree()
+{
+  TEST_ASSERT_EQUAL_INT16(0, parseWindDegree("北风"));
+  TEST_ASSERT_EQUAL_INT16(45, parseWindDegree("东北风"));
+  TEST_ASSERT_EQUAL_INT16(90, parseWindDegree("东风"));
+  TEST_ASSERT_EQUAL_INT16(135, parseWindDegree("东南风"));
+  TEST_ASSERT_EQUAL_INT16(180, parseWindDegree("南风"));
+  TEST_ASSERT_EQUAL_INT16(225, parseWindDegree("西南风"));
+  TEST_ASSERT_EQUAL_INT16(270, parseWindDegree("西风"));
+  TEST_ASSERT_EQUAL_INT16(315, parseWindDegree("西北风"));
+  TEST_ASSERT_EQUAL_INT16(243, parseWindDegree("西南偏西"));
+  TEST_ASSERT_EQUAL_INT16(63, parseWindDegree("东北偏东"));
+}
+
+/* 没有方位或方位相互抵消时未知 */
+static void test_wind_degree_unknown()
+{
+  TEST_ASSERT_EQUAL_INT16(-1, parseWindDegree(""));
+  TEST_ASSERT_EQUAL_INT16(-1, parseWindDegree("静风"));
+  TEST_ASSERT_EQUAL_INT16(-1, parseWindDegree("无持续风向"));
+  TEST_ASSERT_EQUAL_INT16(-1, parseWindDegree("东西"));
+}
+
+static void test_wind_scale()
+{
+  TEST_ASSERT_EQUAL_UINT8(3, parseWindScale("3级"));
+  TEST_ASSERT_EQUAL_UINT8(4, parseWindScale("3-4级"));
+  TEST_ASSERT_EQUAL_UINT8(5, parseWindScale("4级转5级"));
+  TEST_ASSERT_EQUAL_UINT8(12, parseWindScale("12级"));
+  TEST_ASSERT_EQUAL_UINT8(17, parseWindScale("18级")); // 上限
+}
+
+/* "<3级"、"小于3级"与"微风"都表示 2 级 */
+static void test_wind_scale_less_than()
+{
+  TEST_ASSERT_EQUAL_UINT8(2, parseWindScale("<3级"));
+  TEST_ASSERT_EQUAL_UINT8(2, parseWindScale("＜3级"));
+  TEST_ASSERT_EQUAL_UINT8(2, parseWindScale("小于3级"));
+  TEST_ASSERT_EQUAL_UINT8(2, parseWindScale("微风"));
+  TEST_ASSERT_EQUAL_UINT8(0, parseWindScale("<0级"));
+}
+
+static void test_wind_scale_unknown()
+{
+  TEST_ASSERT_EQUAL_UINT8(WIND_SCALE_UNKNOWN, parseWindScale(""));
+  TEST_ASSERT_EQUAL_UINT8(WIND_SCALE_UNKNOWN, parseWindScale("无持续风向"));
+}
+
+static void test_weather_code()
+{
+  TEST_ASSERT_EQUAL(WX_SUNNY, lookupWeatherCode("晴"));
+  TEST_ASSERT_EQUAL(WX_CLOUDY, lookupWeatherCode("多云"));
+  TEST_ASSERT_EQUAL(WX_THUNDERSHOWER_HAIL, lookupWeatherCode("雷阵雨伴有冰雹"));
+  TEST_ASSERT_EQUAL(WX_HEAVY_TO_SEVERE_STORM,
+                    lookupWeatherCode("大暴雨到特大暴雨"));
+  TEST_ASSERT_EQUAL(WX_EXTRA_HEAVY_FOG, lookupWeatherCode("特强浓雾"));
+}
+
+/* 只接受完整匹配 */
+static void test_weather_code_unknown()
+{
+  TEST_ASSERT_EQUAL(WX_UNKNOWN, lookupWeatherCode(""));
+  TEST_ASSERT_EQUAL(WX_UNKNOWN, lookupWeatherCode("晴天"));
+  TEST_ASSERT_EQUAL(WX_UNKNOWN, lookupWeatherCode("大暴"));
+  TEST_ASSERT_EQUAL(WX_UNKNOWN, lookupWeatherCode("sunny"));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_utf8_next);
+  RUN_TEST(test_utf8_invalid);
+  RUN_TEST(test_wind_degree);
+  RUN_TEST(test_wind_degree_unknown);
+  RUN_TEST(test_wind_scale);
+  RUN_TEST(test_wind_scale_less_than);
+  RUN_TEST(test_wind_scale_unknown);
+  RUN_TEST(test_weather_code);
+  RUN_TEST(test_weather_code_unknown);
+  return UNITY_END();
+}
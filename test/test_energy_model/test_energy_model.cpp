@@ -0,0 +1,71 @@
+/* 能耗模型刷新间隔选择的主机测试
+ *
+ * 具体数值按 config.cpp 的默认值 ADAPTIVE_SLEEP_MIN = 15、ADAPTIVE_SLEEP_MAX = 240。
+ * 预算路径（ADAPTIVE_SLEEP = 1）见 test_energy_model_adaptive。
+ * 运行：pio test -e native -f test_energy_model
+ */
+#include <unity.h>
+
+#include "config.h"
+#include "energy_model.h"
+
+void setUp() {}
+void tearDown() {}
+
+/* 取不小于计算结果的最小可选间隔 */
+static void test_rounds_up_to_step()
+{
+  TEST_ASSERT_EQUAL_INT(30, selectSleepStep(20.5f));
+  TEST_ASSERT_EQUAL_INT(30, selectSleepStep(30.0f));
+  TEST_ASSERT_EQUAL_INT(40, selectSleepStep(30.1f));
+  TEST_ASSERT_EQUAL_INT(90, selectSleepStep(61.0f));
+  TEST_ASSERT_EQUAL_INT(180, selectSleepStep(150.0f));
+}
+
+static void test_clamped_to_min()
+{
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MIN, selectSleepStep(0.0f));
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MIN, selectSleepStep(-5.0f));
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MIN, selectSleepStep(11.0f));
+}
+
+/* 电量预算不足（间隔很大或超出所有可选值）时取上限 */
+static void test_clamped_to_max()
+{
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MAX, selectSleepStep(241.0f));
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MAX, selectSleepStep(1000.0f));
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MAX, selectSleepStep(5000.0f));
+}
+
+/* 结果均为 1440 的约数，保持与 WAKE_TIME 的分钟对齐 */
+static void test_steps_divide_day()
+{
+  for (int interval = 0; interval <= 1500; interval += 7)
+  {
+    int step = selectSleepStep(interval);
+    TEST_ASSERT_EQUAL_INT(0, 1440 % step);
+    TEST_ASSERT_GREATER_OR_EQUAL(ADAPTIVE_SLEEP_MIN, step);
+    TEST_ASSERT_LESS_OR_EQUAL(ADAPTIVE_SLEEP_MAX, step);
+  }
+}
+
+/* 默认关闭自适应刷新：不论电量与唤醒时长，都按 SLEEP_DURATION 刷新 */
+static void test_default_off()
+{
+  TEST_ASSERT_EQUAL_INT(0, ADAPTIVE_SLEEP);
+  observeBatteryVoltage(LOW_BATTERY_VOLTAGE);
+  TEST_ASSERT_EQUAL_INT(SLEEP_DURATION, chooseSleepInterval(60000));
+  observeBatteryVoltage(MAX_BATTERY_VOLTAGE);
+  TEST_ASSERT_EQUAL_INT(SLEEP_DURATION, chooseSleepInterval(1000));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_rounds_up_to_step);
+  RUN_TEST(test_clamped_to_min);
+  RUN_TEST(test_clamped_to_max);
+  RUN_TEST(test_steps_divide_day);
+  RUN_TEST(test_default_off);
+  return UNITY_END();
+}
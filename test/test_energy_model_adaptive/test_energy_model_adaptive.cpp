@@ -0,0 +1,132 @@
+/* 能耗模型按电量预算选择刷新间隔的主机测试（ADAPTIVE_SLEEP = 1）
+ *
+ * 具体数值按 config.cpp 的默认值：BATTERY_CAPACITY = 5000mAh、TARGET_RUNTIME = 180 天、
+ * AWAKE_CURRENT = 80mA、SLEEP_CURRENT = 15uA、WAKE_TIME 06 至 BED_TIME 00。
+ * 唤醒 5 秒时满电的预算约每天 220 次唤醒，远多于 ADAPTIVE_SLEEP_MIN 的刷新次数。
+ *
+ * 模型状态保存在 RTC 内存（文件内静态变量）中，各测试按 main() 中的顺序依次进行，
+ * 相当于连续的几次唤醒。
+ * 运行：pio test -e native_adaptive
+ */
+#include <time.h>
+#include <unity.h>
+#include <Preferences.h>
+
+#include "config.h"
+#include "energy_model.h"
+
+static const unsigned long AWAKE_MS = 5000;
+
+void setUp() {}
+void tearDown() {}
+
+static cma_weather_t calmWeather()
+{
+  cma_weather_t w = {};
+  strcpy(w.weather1, "晴");
+  strcpy(w.weather2, "晴");
+  w.temperature = 20.0f;
+  return w;
+}
+
+static time_t planEnd()
+{
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, true);
+  time_t end = prefs.getULong64("planEnd", 0);
+  prefs.end();
+  return end;
+}
+
+/* 尚未测得电池电量时按 SLEEP_DURATION 刷新，不开始续航计划 */
+static void test_unknown_battery()
+{
+  TEST_ASSERT_EQUAL_INT(SLEEP_DURATION, chooseSleepInterval(AWAKE_MS));
+  TEST_ASSERT_EQUAL_INT64(0, planEnd());
+}
+
+/* 冷启动时电量已降到 LOW_BATTERY_VOLTAGE，可用电量耗尽，取 ADAPTIVE_SLEEP_MAX */
+static void test_budget_exhausted_clamped_to_max()
+{
+  observeBatteryVoltage(LOW_BATTERY_VOLTAGE);
+  observeWeatherVolatility(calmWeather());
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MAX, chooseSleepInterval(AWAKE_MS));
+  // 开始续航计划
+  time_t end = planEnd();
+  TEST_ASSERT_INT64_WITHIN(5, time(NULL) + TARGET_RUNTIME * 86400LL, end);
+
+  observeBatteryVoltage(MIN_BATTERY_VOLTAGE);
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MAX, chooseSleepInterval(AWAKE_MS));
+  // 电量下降不重新开始计划
+  TEST_ASSERT_EQUAL_INT64(end, planEnd());
+}
+
+/* 天气变化剧烈时间隔缩短一半 */
+static void test_volatile_weather_halves_interval()
+{
+  observeBatteryVoltage(LOW_BATTERY_VOLTAGE);
+  cma_weather_t w = calmWeather();
+  w.precipitation = 1.5f;
+  observeWeatherVolatility(w);
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MAX / 2, chooseSleepInterval(AWAKE_MS));
+  observeWeatherVolatility(calmWeather());
+}
+
+/* 充电后重新开始续航计划；满电时预算充裕，计算出的间隔短于下限，
+ * 取 ADAPTIVE_SLEEP_MIN
+ */
+static void test_recharge_clamped_to_min()
+{
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, false);
+  prefs.putULong64("planEnd", time(NULL) + 86400);
+  prefs.end();
+
+  observeBatteryVoltage(MAX_BATTERY_VOLTAGE);
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MIN, chooseSleepInterval(AWAKE_MS));
+  TEST_ASSERT_INT64_WITHIN(5, time(NULL) + TARGET_RUNTIME * 86400LL,
+                           planEnd());
+}
+
+/* 唤醒时长很长时，满电也负担不起下限的刷新频率 */
+static void test_long_awake_time()
+{
+  observeBatteryVoltage(MAX_BATTERY_VOLTAGE);
+  int interval = ADAPTIVE_SLEEP_MIN;
+  for (int i = 0; i < 40; ++i)
+  { // 唤醒时长按指数加权平均，需多次唤醒才收敛
+    interval = chooseSleepInterval(300000);
+  }
+  // 300 秒约 6.7mAh/次，每天约 3.6 次，间隔约 300 分钟
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MAX, interval);
+
+  for (int i = 0; i < 40; ++i)
+  {
+    interval = chooseSleepInterval(60000);
+  }
+  // 60 秒约 1.33mAh/次，每天约 18 次，间隔约 59 分钟，取 60
+  TEST_ASSERT_EQUAL_INT(60, interval);
+}
+
+/* 续航计划已到期：剩余天数按 1 天计，可用电量全部计入当天的预算 */
+static void test_plan_expired()
+{
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, false);
+  prefs.putULong64("planEnd", time(NULL) - 86400);
+  prefs.end();
+  TEST_ASSERT_EQUAL_INT(ADAPTIVE_SLEEP_MIN, chooseSleepInterval(300000));
+}
+
+int main(int argc, char **argv)
+{
+  Preferences::clearAll();
+  UNITY_BEGIN();
+  RUN_TEST(test_unknown_battery);
+  RUN_TEST(test_budget_exhausted_clamped_to_max);
+  RUN_TEST(test_volatile_weather_halves_interval);
+  RUN_TEST(test_recharge_clamped_to_min);
+  RUN_TEST(test_long_awake_time);
+  RUN_TEST(test_plan_expired);
+  return UNITY_END();
+}
@@ -0,0 +1,273 @@
+/* getCMAweather() 请求路径的主机测试
+ *
+ * 每个场景启动一个 test/mock_cma_server.py（--port 0，由系统分配端口），按 --script
+ * 逐个请求返回响应，经 WiFiClient/HTTPClient 替身走完与设备相同的重试、退避与
+ * 总时限逻辑。每个场景输出一行统计：耗时、请求数、重试次数、建立的连接数与
+ * 堆内存峰值（不含 JSON 静态区与解压字典等静态缓冲区）。
+ * 需要 python3；无法启动模拟服务器时跳过。
+ * 运行：pio test -e native -f test_fetch -v
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unity.h>
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+
+#include "api_response.h"
+#include "client_utils.h"
+#include "config.h"
+
+// 统计堆内存：每块前附 16 字节记录大小
+static size_t heapInUse = 0;
+static size_t heapPeak = 0;
+
+void *operator new(size_t size)
+{
+  size_t *p = static_cast<size_t *>(malloc(size + 16));
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  *p = size;
+  heapInUse += size;
+  if (heapInUse > heapPeak)
+  {
+    heapPeak = heapInUse;
+  }
+  return reinterpret_cast<char *>(p) + 16;
+}
+
+void operator delete(void *p) noexcept
+{
+  if (p != NULL)
+  {
+    size_t *block = reinterpret_cast<size_t *>(static_cast<char *>(p) - 16);
+    heapInUse -= *block;
+    free(block);
+  }
+}
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+typedef struct fetch_result {
+  int status;
+  unsigned long ms;
+  unsigned requests;
+  unsigned connects;
+  size_t peakHeap;
+  cma_weather_t weather;
+} fetch_result_t;
+
+static pid_t serverPid = -1;
+
+void setUp() {}
+
+void tearDown()
+{
+  if (serverPid > 0)
+  {
+    kill(serverPid, SIGTERM);
+    waitpid(serverPid, NULL, 0);
+    serverPid = -1;
+  }
+}
+
+/* 启动模拟服务器，返回其端口，失败返回0 */
+static uint16_t startServer(const char *script, bool gzip)
+{
+  int fds[2];
+  if (pipe(fds) != 0)
+  {
+    return 0;
+  }
+  serverPid = fork();
+  if (serverPid == 0)
+  {
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[0]);
+    close(fds[1]);
+    execlp("python3", "python3", "test/mock_cma_server.py", "--port", "0",
+           "--script", script, gzip ? "--gzip" : NULL, (char *)NULL);
+    _exit(127);
+  }
+  close(fds[1]);
+  // 第一行：模拟服务器：端口 <port>，场景 ...
+  FILE *out = fdopen(fds[0], "r");
+  char line[256] = "";
+  unsigned port = 0;
+  if (serverPid > 0 && fgets(line, sizeof(line), out) != NULL)
+  {
+    const char *p = strstr(line, "端口 ");
+    if (p != NULL)
+    {
+      port = strtoul(p + strlen("端口 "), NULL, 10);
+    }
+  }
+  fclose(out);
+  return static_cast<uint16_t>(port);
+}
+
+/* 按脚本请求一次全部地点，输出统计行 */
+static bool fetch(const char *script, bool gzip, fetch_result_t &res)
+{
+  uint16_t port = startServer(script, gzip);
+  if (port == 0)
+  {
+    return false;
+  }
+  WiFiClient::redirectPort  = port;
+  WiFiClient::connectCount  = 0;
+  HTTPClient::requestCount  = 0;
+
+  WiFiClient client;
+  cma_weather_t r[CMA_MAX_LOCATIONS] = {};
+  int status[CMA_MAX_LOCATIONS] = {};
+  heapPeak = heapInUse;
+  const size_t heapBase = heapInUse;
+  auto start = std::chrono::steady_clock::now();
+  res.status = getCMAweather(client, r, status);
+  res.ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start).count();
+  res.requests = HTTPClient::requestCount;
+  res.connects = WiFiClient::connectCount;
+  res.peakHeap = heapPeak - heapBase;
+  res.weather  = r[0];
+
+  char msg[200];
+  snprintf(msg, sizeof(msg),
+           "%s%s：状态 %d，%lu 毫秒，%u 次请求（重试 %u 次），%u 次连接，"
+           "堆峰值 %zu 字节",
+           script, gzip ? "（gzip）" : "", res.status, res.ms, res.requests,
+           res.requests > 0 ? res.requests - 1 : 0, res.connects,
+           res.peakHeap);
+  TEST_MESSAGE(msg);
+  return true;
+}
+
+#define FETCH(script, gzip, res)                       \
+  do {                                                 \
+    if (!fetch(script, gzip, res))                     \
+    {                                                  \
+      TEST_IGNORE_MESSAGE("无法启动模拟服务器");       \
+    }                                                  \
+  } while (0)
+
+static void test_ok()
+{
+  fetch_result_t res;
+  FETCH("ok", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_OK, res.status);
+  TEST_ASSERT_EQUAL_UINT32(CMA_LOCATION_COUNT, res.requests);
+  TEST_ASSERT_EQUAL_UINT32(1, res.connects);
+  TEST_ASSERT_EQUAL_FLOAT(26.5f, res.weather.temperature);
+}
+
+/* 压缩后约 1KB，解压后约 40KB，大于旧的 8KB 输出缓冲区 */
+static void test_oversized_gzip()
+{
+  fetch_result_t res;
+  FETCH("oversized", true, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_OK, res.status);
+  TEST_ASSERT_EQUAL_UINT32(CMA_LOCATION_COUNT, res.requests);
+  TEST_ASSERT_EQUAL_FLOAT(26.5f, res.weather.temperature);
+}
+
+/* 请求为 HTTP/1.0，服务器不得使用分块传输编码 */
+static void test_chunked_http10()
+{
+  fetch_result_t res;
+  FETCH("chunked", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_OK, res.status);
+  TEST_ASSERT_EQUAL_UINT32(CMA_LOCATION_COUNT, res.requests);
+}
+
+static void test_slow()
+{
+  fetch_result_t res;
+  FETCH("slow:0.01", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_OK, res.status);
+  TEST_ASSERT_EQUAL_UINT32(CMA_LOCATION_COUNT, res.requests);
+}
+
+static void test_latency()
+{
+  fetch_result_t res;
+  FETCH("latency:0.3", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_OK, res.status);
+  TEST_ASSERT_GREATER_OR_EQUAL(300, res.ms);
+}
+
+/* 503 后退避重试；错误响应体已读完，连接保留给重试 */
+static void test_server_error_retry()
+{
+  fetch_result_t res;
+  FETCH("status:503,ok", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_OK, res.status);
+  TEST_ASSERT_EQUAL_UINT32(CMA_LOCATION_COUNT + 1, res.requests);
+  TEST_ASSERT_EQUAL_UINT32(1, res.connects);
+  // 首次退避为 [HTTP_RETRY_BACKOFF / 2, HTTP_RETRY_BACKOFF]
+  TEST_ASSERT_GREATER_OR_EQUAL(HTTP_RETRY_BACKOFF / 2, res.ms);
+}
+
+/* 响应体不完整：断开后重新连接重试 */
+static void test_truncated_retry()
+{
+  fetch_result_t res;
+  FETCH("truncated,ok", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_OK, res.status);
+  TEST_ASSERT_EQUAL_UINT32(CMA_LOCATION_COUNT + 1, res.requests);
+  TEST_ASSERT_EQUAL_UINT32(2, res.connects);
+  TEST_ASSERT_EQUAL_FLOAT(26.5f, res.weather.temperature);
+}
+
+/* 服务器未响应即断开：重新连接重试 */
+static void test_dropped_retry()
+{
+  fetch_result_t res;
+  FETCH("drop,ok", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_OK, res.status);
+  TEST_ASSERT_EQUAL_UINT32(CMA_LOCATION_COUNT + 1, res.requests);
+  TEST_ASSERT_EQUAL_UINT32(2, res.connects);
+}
+
+/* 404 重试无意义，不再请求 */
+static void test_not_found_fatal()
+{
+  fetch_result_t res;
+  FETCH("status:404,ok", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_NOT_FOUND, res.status);
+  TEST_ASSERT_EQUAL_UINT32(1, res.requests);
+}
+
+/* 服务器持续不可用：退避重试至 HTTP_REQUEST_DEADLINE 内放弃 */
+static void test_deadline()
+{
+  fetch_result_t res;
+  FETCH("status:503", false, res);
+  TEST_ASSERT_EQUAL_INT(HTTP_CODE_SERVICE_UNAVAILABLE, res.status);
+  TEST_ASSERT_GREATER_OR_EQUAL(3, res.requests);
+  TEST_ASSERT_LESS_OR_EQUAL(HTTP_REQUEST_DEADLINE + 500, res.ms);
+}
+
+int main(int argc, char **argv)
+{
+  signal(SIGPIPE, SIG_IGN);
+  realMillis = true;
+  UNITY_BEGIN();
+  RUN_TEST(test_ok);
+  RUN_TEST(test_oversized_gzip);
+  RUN_TEST(test_chunked_http10);
+  RUN_TEST(test_slow);
+  RUN_TEST(test_latency);
+  RUN_TEST(test_server_error_retry);
+  RUN_TEST(test_truncated_retry);
+  RUN_TEST(test_dropped_retry);
+  RUN_TEST(test_not_found_fatal);
+  RUN_TEST(test_deadline);
+  return UNITY_END();
+}
@@ -0,0 +1,222 @@
+/* gzip/deflate 响应解压流的主机测试
+ *
+ * 压缩数据由主机的 zlib 在测试中生成。
+ * 运行：pio test -e native -f test_inflate_stream
+ */
+#include <string>
+#include <unity.h>
+#include <zlib.h>
+#include <MemoryStream.h>
+
+#include "inflate_stream.h"
+
+static const char TEXT[] =
+  "{\"code\":200,\"place\":\"中国, 北京, 北京\",\"weather1\":\"多云\","
+  "\"weather2\":\"晴\",\"windDirection\":\"东南风\",\"windScale\":\"微风\"}";
+
+void setUp() {}
+void tearDown() {}
+
+/* 按 windowBits 压缩：15 为 zlib 封装，-15 为原始 deflate，31 为 gzip */
+static std::string compress(const std::string &s, int windowBits)
+{
+  z_stream z = {};
+  deflateInit2(&z, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8,
+               Z_DEFAULT_STRATEGY);
+  std::string out(deflateBound(&z, s.size()) + 32, '\0');
+  z.next_in   = reinterpret_cast<Bytef *>(const_cast<char *>(s.data()));
+  z.avail_in  = s.size();
+  z.next_out  = reinterpret_cast<Bytef *>(&out[0]);
+  z.avail_out = out.size();
+  deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  return out;
+}
+
+/* 带可选字段的 gzip 文件：flags 中的 FEXTRA、FNAME、FCOMMENT、FHCRC 各附一段 */
+static std::string gzipWithFields(const std::string &s, uint8_t flags)
+{
+  std::string gz("\x1F\x8B\x08", 3);
+  gz += static_cast<char>(flags);
+  gz += std::string(6, '\0'); // MTIME、XFL、OS
+  if (flags & 0x04)
+  {
+    gz += std::string("\x05\x00" "extra", 7);
+  }
+  if (flags & 0x08)
+  {
+    gz += std::string("response.json", 14);
+  }
+  if (flags & 0x10)
+  {
+    gz += std::string("comment", 8);
+  }
+  if (flags & 0x02)
+  {
+    gz += std::string("\x12\x34", 2);
+  }
+  gz += compress(s, -15);
+  uint32_t crc = crc32(0, reinterpret_cast<const Bytef *>(s.data()),
+                       s.size());
+  uint32_t isize = s.size();
+  for (uint32_t v : {crc, isize})
+  {
+    for (int i = 0; i < 4; ++i)
+    {
+      gz += static_cast<char>(v >> (8 * i));
+    }
+  }
+  return gz;
+}
+
+/* 读出全部解压数据 */
+static std::string readAll(Stream &s)
+{
+  std::string out;
+  for (int c; (c = s.read()) >= 0; )
+  {
+    out += static_cast<char>(c);
+  }
+  return out;
+}
+
+static void test_parse_content_encoding()
+{
+  TEST_ASSERT_EQUAL(CONTENT_IDENTITY, parseContentEncoding(""));
+  TEST_ASSERT_EQUAL(CONTENT_IDENTITY, parseContentEncoding("identity"));
+  TEST_ASSERT_EQUAL(CONTENT_GZIP, parseContentEncoding("gzip"));
+  TEST_ASSERT_EQUAL(CONTENT_GZIP, parseContentEncoding("GZip"));
+  TEST_ASSERT_EQUAL(CONTENT_GZIP, parseContentEncoding("x-gzip"));
+  TEST_ASSERT_EQUAL(CONTENT_DEFLATE, parseContentEncoding("Deflate"));
+  TEST_ASSERT_EQUAL(CONTENT_UNSUPPORTED, parseContentEncoding("br"));
+  TEST_ASSERT_EQUAL(CONTENT_UNSUPPORTED, parseContentEncoding("gzip, br"));
+}
+
+/* 读完数据后文件尾也被读取，连接可复用 */
+static void test_gzip()
+{
+  std::string gz = compress(TEXT, 31);
+  MemoryStream src(gz.data(), gz.size());
+  InflateStream in(src, CONTENT_GZIP);
+  TEST_ASSERT_TRUE(in.begin());
+  TEST_ASSERT_EQUAL_STRING(TEXT, readAll(in).c_str());
+  TEST_ASSERT_EQUAL_size_t(gz.size(), src.position());
+}
+
+/* 文件头的可选字段（RFC 1952 第 2.3 节）被正确跳过 */
+static void test_gzip_header_fields()
+{
+  for (uint8_t flags : {0x02, 0x04, 0x08, 0x10, 0x1E})
+  {
+    std::string gz = gzipWithFields(TEXT, flags);
+    MemoryStream src(gz.data(), gz.size());
+    InflateStream in(src, CONTENT_GZIP);
+    TEST_ASSERT_TRUE(in.begin());
+    TEST_ASSERT_EQUAL_STRING(TEXT, readAll(in).c_str());
+    TEST_ASSERT_EQUAL_size_t(gz.size(), src.position());
+  }
+}
+
+static void test_gzip_bad_header()
+{
+  std::string gz = compress(TEXT, 31);
+  gz[1] = 0x8C;
+  MemoryStream bad(gz.data(), gz.size());
+  InflateStream in(bad, CONTENT_GZIP);
+  TEST_ASSERT_FALSE(in.begin());
+
+  // 文件头在可选字段中截断
+  std::string hdr = gzipWithFields(TEXT, 0x08).substr(0, 15);
+  MemoryStream cut(hdr.data(), hdr.size());
+  InflateStream in2(cut, CONTENT_GZIP);
+  TEST_ASSERT_FALSE(in2.begin());
+}
+
+/* HTTP 的 deflate 可能是 zlib 封装，也可能是原始 deflate */
+static void test_deflate()
+{
+  for (int windowBits : {15, -15})
+  {
+    std::string z = compress(TEXT, windowBits);
+    MemoryStream src(z.data(), z.size());
+    InflateStream in(src, CONTENT_DEFLATE);
+    TEST_ASSERT_TRUE(in.begin());
+    TEST_ASSERT_EQUAL_STRING(TEXT, readAll(in).c_str());
+  }
+}
+
+/* 压缩数据分段到达时结果不变 */
+static void test_chunked_input()
+{
+  std::string gz = gzipWithFields(TEXT, 0x1E);
+  MemoryStream src(gz.data(), gz.size(), 3);
+  InflateStream in(src, CONTENT_GZIP);
+  TEST_ASSERT_TRUE(in.begin());
+  TEST_ASSERT_EQUAL_STRING(TEXT, readAll(in).c_str());
+}
+
+/* 远大于 32KB 字典的响应：字典多次回绕，回溯引用跨过回绕点 */
+static std::string largeBody()
+{
+  std::string block;
+  uint32_t x = 12345;
+  while (block.size() < 20000)
+  { // 不可压缩的伪随机内容，迫使 deflate 使用远距离的回溯引用
+    x = x * 1103515245 + 12345;
+    block += static_cast<char>('a' + (x >> 16) % 26);
+  }
+  std::string body = "{\"code\":200,\"blob\":\"";
+  for (int i = 0; i < 6; ++i)
+  {
+    body += block; // 与上一段相隔 20000 字节
+  }
+  return body + "\"}";
+}
+
+static void test_large_body()
+{
+  std::string body = largeBody();
+  TEST_ASSERT_GREATER_THAN(3 * 32768, body.size());
+  std::string gz = compress(body, 31);
+  TEST_ASSERT_LESS_THAN(body.size() / 4, gz.size());
+  MemoryStream src(gz.data(), gz.size());
+  InflateStream in(src, CONTENT_GZIP);
+  TEST_ASSERT_TRUE(in.begin());
+  std::string out = readAll(in);
+  TEST_ASSERT_EQUAL_size_t(body.size(), out.size());
+  TEST_ASSERT_TRUE(out == body);
+  TEST_ASSERT_EQUAL_size_t(gz.size(), src.position());
+
+  // 分段到达的 deflate 同样完整
+  std::string z = compress(body, 15);
+  MemoryStream chunked(z.data(), z.size(), 100);
+  InflateStream in2(chunked, CONTENT_DEFLATE);
+  TEST_ASSERT_TRUE(in2.begin());
+  TEST_ASSERT_TRUE(readAll(in2) == body);
+}
+
+/* 截断的压缩数据在已解压的部分之后结束 */
+static void test_truncated()
+{
+  std::string gz = compress(TEXT, 31);
+  gz.resize(gz.size() / 2);
+  MemoryStream src(gz.data(), gz.size());
+  InflateStream in(src, CONTENT_GZIP);
+  TEST_ASSERT_TRUE(in.begin());
+  TEST_ASSERT_LESS_THAN(strlen(TEXT), readAll(in).size());
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_content_encoding);
+  RUN_TEST(test_gzip);
+  RUN_TEST(test_gzip_header_fields);
+  RUN_TEST(test_gzip_bad_header);
+  RUN_TEST(test_deflate);
+  RUN_TEST(test_chunked_input);
+  RUN_TEST(test_large_body);
+  RUN_TEST(test_truncated);
+  return UNITY_END();
+}
@@ -0,0 +1,144 @@
+/* 按像素宽度断行的主机测试
+ *
+ * 使用测试中构造的字体：8 位 GFX 字体（U+0020..U+00FF，每字步进 6）与配对的中文字体
+ * （"。"、"中"、"文"、"（"，每字步进 13）。
+ * 运行：pio test -e native -f test_line_break
+ */
+#include <cstring>
+#include <string>
+#include <unity.h>
+
+#include "line_break.h"
+#include "text_metrics.h"
+
+static const uint16_t FIRST = 0x20, LAST = 0xFF;
+static GFXglyph latinGlyphs[LAST - FIRST + 1];
+static uint8_t latinBitmap[1];
+static GFXfont font = {latinBitmap, latinGlyphs, FIRST, LAST, 10};
+
+static const uint8_t cjkBitmap[24] = {};
+static const cjk_glyph_t cjkGlyphs[] = {
+  {0, 12, 12, 13, 0, -11},
+  {0, 12, 12, 13, 0, -11},
+  {0, 12, 12, 13, 0, -11},
+  {0, 12, 12, 13, 0, -11},
+};
+static const uint16_t cjkCodepoints[] = {0x3002, 0x4E2D, 0x6587, 0xFF08};
+static const cjk_font_t cjk = {cjkBitmap, cjkGlyphs, cjkCodepoints, 4, 14};
+
+void setUp() {}
+void tearDown() {}
+
+/* 断出一行，返回行的内容，下一行的开头写入 rest */
+static std::string line(const char *text, uint16_t maxWidth,
+                        std::string &rest)
+{
+  text_line_t l = breakLine(&font, text, maxWidth);
+  rest = l.next;
+  return std::string(text, l.len);
+}
+
+static void test_fits()
+{
+  std::string rest;
+  TEST_ASSERT_EQUAL_STRING("hello", line("hello", 100, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("", rest.c_str());
+  TEST_ASSERT_EQUAL_STRING("", line("", 100, rest).c_str());
+}
+
+/* 在空格处断开，行尾空格去掉，下一行跳过行首空格 */
+static void test_break_at_space()
+{
+  std::string rest;
+  TEST_ASSERT_EQUAL_STRING("hello", line("hello   world", 40, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("world", rest.c_str());
+  // 行尾的空格不计宽度
+  TEST_ASSERT_EQUAL_STRING("hello", line("hello world", 30, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("world", rest.c_str());
+}
+
+static void test_break_after_hyphen()
+{
+  std::string rest;
+  TEST_ASSERT_EQUAL_STRING("well-", line("well-known", 36, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("known", rest.c_str());
+}
+
+/* 一个词超过整行宽度时在字符之间强制断开，每行至少一个字符 */
+static void test_forced_break()
+{
+  std::string rest;
+  TEST_ASSERT_EQUAL_STRING("abc", line("abcdefghij", 20, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("defghij", rest.c_str());
+  TEST_ASSERT_EQUAL_STRING("a", line("abc", 1, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("中", line("中文", 5, rest).c_str());
+}
+
+static void test_newline()
+{
+  std::string rest;
+  TEST_ASSERT_EQUAL_STRING("ab", line("ab\ncd", 100, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("cd", rest.c_str());
+}
+
+/* 中日韩文字之间可以断行 */
+static void test_cjk()
+{
+  std::string rest;
+  TEST_ASSERT_EQUAL_STRING("中文中", line("中文中文", 40, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("文", rest.c_str());
+  TEST_ASSERT_EQUAL_STRING("ab", line("ab中文", 20, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("中文", rest.c_str());
+}
+
+/* 闭合标点不出现在行首，开括号不出现在行尾 */
+static void test_kinsoku()
+{
+  std::string rest;
+  TEST_ASSERT_EQUAL_STRING("中文", line("中文中。", 40, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("中。", rest.c_str());
+  TEST_ASSERT_EQUAL_STRING("中文", line("中文（中", 40, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("（中", rest.c_str());
+}
+
+/* 以 Latin-1 书写的字节按一个字符计算宽度，与测量一致 */
+static void test_latin1()
+{
+  std::string rest;
+  TEST_ASSERT_EQUAL_STRING("\260C", line("\260C \260C", 26, rest).c_str());
+  TEST_ASSERT_EQUAL_STRING("\260C", rest.c_str());
+}
+
+static void test_ellipsis()
+{
+  TEST_ASSERT_EQUAL_size_t(4, fitWithEllipsis(&font, "hello world", 40, 12));
+  TEST_ASSERT_EQUAL_size_t(8, fitWithEllipsis(&font, "hello world", 60, 12));
+  // 去掉结尾的空格
+  TEST_ASSERT_EQUAL_size_t(5, fitWithEllipsis(&font, "hello world", 48, 12));
+  // 按字符截断，不截断在多字节字符中间
+  TEST_ASSERT_EQUAL_size_t(6, fitWithEllipsis(&font, "中文中文", 40, 12));
+  TEST_ASSERT_EQUAL_size_t(0, fitWithEllipsis(&font, "中文", 20, 12));
+  // 只截取第一行
+  TEST_ASSERT_EQUAL_size_t(2, fitWithEllipsis(&font, "ab\ncd", 100, 12));
+}
+
+int main(int argc, char **argv)
+{
+  for (uint16_t cp = FIRST; cp <= LAST; ++cp)
+  {
+    latinGlyphs[cp - FIRST] = {0, 5, 7, 6, 0, -7};
+  }
+  registerCjkFont(&font, &cjk);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_fits);
+  RUN_TEST(test_break_at_space);
+  RUN_TEST(test_break_after_hyphen);
+  RUN_TEST(test_forced_break);
+  RUN_TEST(test_newline);
+  RUN_TEST(test_cjk);
+  RUN_TEST(test_kinsoku);
+  RUN_TEST(test_latin1);
+  RUN_TEST(test_ellipsis);
+  return UNITY_END();
+}
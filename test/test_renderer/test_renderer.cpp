@@ -0,0 +1,194 @@
+/* 渲染器的主机测试：绘制到内存帧缓冲，与基准图像逐像素比较
+ *
+ * display 由 test/shims/GxEPD2_BW.h 中的帧缓冲代替（GFXcanvas1），各绘制函数分别
+ * 绘制一帧，写为 .pio/render/<名称>.pbm，并与 test/test_renderer/golden/ 中的同名
+ * 基准图像比较。每帧输出一行统计：绘制耗时、图元数与像素数。
+ * 未定义 CJK_FONT_HEADER，中文字符被跳过，测试数据中的文字以 ASCII 为主。
+ *
+ * 绘制结果有意改变时，以 UPDATE_GOLDEN=1 运行以重新生成基准图像，并检查其内容。
+ * 运行：pio test -e native -f test_renderer -v
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <unity.h>
+
+#include "config.h"
+#include "renderer.h"
+#include "icons/196x196/wifi_x_196x196.h"
+
+static const char GOLDEN_DIR[] = "test/test_renderer/golden/";
+static const char OUTPUT_DIR[] = ".pio/render/";
+
+static const size_t FRAME_BYTES = (DISP_WIDTH + 7) / 8 * DISP_HEIGHT;
+
+void setUp()
+{
+  display.firstPage(); // 清为白色
+  display.resetStats();
+}
+void tearDown() {}
+
+static cma_weather_t sampleWeather()
+{
+  cma_weather_t w = {};
+  strcpy(w.weather1, "Cloudy");
+  strcpy(w.weather2, "Sunny");
+  strcpy(w.windDirection, "SE");
+  strcpy(w.place, "Beijing");
+  w.weather1Code   = WX_CLOUDY;
+  w.weather2Code   = WX_SUNNY;
+  w.temperature    = 26.5f;
+  w.humidity       = 60;
+  w.windSpeed      = 2.4f;
+  w.windScaleLevel = 2;
+  w.precipitation  = 0.0f;
+  return w;
+}
+
+/* 以二进制 PBM（P4）格式写出当前帧 */
+static bool writePbm(const std::string &path)
+{
+  FILE *f = fopen(path.c_str(), "wb");
+  if (f == NULL)
+  {
+    return false;
+  }
+  fprintf(f, "P4\n%d %d\n", DISP_WIDTH, DISP_HEIGHT);
+  bool ok = fwrite(display.getBuffer(), 1, FRAME_BYTES, f) == FRAME_BYTES;
+  return fclose(f) == 0 && ok;
+}
+
+/* 读取 PBM（P4）格式的基准图像，尺寸不符或读取失败返回false */
+static bool readPbm(const std::string &path, std::string &frame)
+{
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == NULL)
+  {
+    return false;
+  }
+  int w = 0, h = 0;
+  bool ok = fscanf(f, "P4 %d %d", &w, &h) == 2 && fgetc(f) == '\n'
+            && w == DISP_WIDTH && h == DISP_HEIGHT;
+  frame.assign(FRAME_BYTES, '\0');
+  ok = ok && fread(&frame[0], 1, FRAME_BYTES, f) == FRAME_BYTES;
+  fclose(f);
+  return ok;
+}
+
+/* 与基准图像比较，返回不同的像素数 */
+static size_t diffPixels(const std::string &golden)
+{
+  const uint8_t *frame = display.getBuffer();
+  size_t diff = 0;
+  for (size_t i = 0; i < FRAME_BYTES; ++i)
+  {
+    diff += __builtin_popcount(frame[i] ^ static_cast<uint8_t>(golden[i]));
+  }
+  return diff;
+}
+
+/* 输出统计，写出当前帧，并与名为 name 的基准图像比较 */
+static void checkFrame(const char *name, double us)
+{
+  char msg[160];
+  snprintf(msg, sizeof(msg), "%s：%.0f 微秒，%u 个图元，%u 个像素", name, us,
+           static_cast<unsigned>(display.primitives),
+           static_cast<unsigned>(display.pixels));
+  TEST_MESSAGE(msg);
+
+  mkdir(".pio", 0755);
+  mkdir(OUTPUT_DIR, 0755);
+  writePbm(std::string(OUTPUT_DIR) + name + ".pbm");
+
+  const std::string goldenPath = std::string(GOLDEN_DIR) + name + ".pbm";
+  const char *update = getenv("UPDATE_GOLDEN");
+  if (update != NULL && *update != '\0' && *update != '0')
+  {
+    TEST_ASSERT_TRUE(writePbm(goldenPath));
+    return;
+  }
+  std::string golden;
+  if (!readPbm(goldenPath, golden))
+  {
+    TEST_FAIL_MESSAGE("基准图像不存在或格式不符，以 UPDATE_GOLDEN=1 运行生成");
+  }
+  size_t diff = diffPixels(golden);
+  if (diff != 0)
+  {
+    snprintf(msg, sizeof(msg), "%s 与基准图像有 %u 个像素不同", name,
+             static_cast<unsigned>(diff));
+    TEST_FAIL_MESSAGE(msg);
+  }
+}
+
+/* 计时运行一个绘制函数 */
+template <typename F>
+static double timeRender(F draw)
+{
+  auto start = std::chrono::steady_clock::now();
+  draw();
+  return std::chrono::duration<double, std::micro>(
+           std::chrono::steady_clock::now() - start).count();
+}
+
+static void test_current_weather()
+{
+  const cma_weather_t w = sampleWeather();
+  double us = timeRender([&] { drawCurrentWeather(w, 23.4f, 45.6f); });
+  checkFrame("current_weather", us);
+}
+
+/* 经显示列表记录后重放，结果须与直接绘制相同 */
+static void test_current_weather_display_list()
+{
+  const cma_weather_t w = sampleWeather();
+  double us = timeRender([&] {
+    beginDisplayList();
+    drawCurrentWeather(w, 23.4f, 45.6f);
+    endDisplayList();
+    replayDisplayList(0);
+  });
+  checkFrame("current_weather", us);
+}
+
+static void test_location_date()
+{
+  double us = timeRender([] {
+    drawLocationDate("Beijing", "Friday, June 28, 2024");
+  });
+  checkFrame("location_date", us);
+}
+
+static void test_status_bar()
+{
+  double us = timeRender([] {
+    drawStatusBar("API error", "16:40", -60, 3900);
+  });
+  checkFrame("status_bar", us);
+}
+
+/* 第二行为空时按宽度断行，超过两行以省略号截断 */
+static void test_error()
+{
+  double us = timeRender([] {
+    drawError(wifi_x_196x196,
+              "Weather service returned 503 Service Unavailable, "
+              "will retry at the next scheduled refresh");
+  });
+  checkFrame("error", us);
+}
+
+int main(int argc, char **argv)
+{
+  initDisplay();
+  UNITY_BEGIN();
+  RUN_TEST(test_current_weather);
+  RUN_TEST(test_current_weather_display_list);
+  RUN_TEST(test_location_date);
+  RUN_TEST(test_status_bar);
+  RUN_TEST(test_error);
+  return UNITY_END();
+}
@@ -0,0 +1,74 @@
+/* 深度睡眠定时器漂移校准的主机测试
+ *
+ * 运行：pio test -e native -f test_sleep_drift
+ */
+#include <unity.h>
+#include <Preferences.h>
+
+#include "config.h"
+#include "sleep_drift.h"
+
+void setUp()
+{
+  Preferences::clearAll();
+}
+
+void tearDown() {}
+
+static void test_rate_single_step()
+{
+  // 指数加权平均：每次向观测值靠近 1/4
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.9995f, updateSleepRate(1.0f, 0.998f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0005f, updateSleepRate(1.0f, 1.002f));
+}
+
+static void test_rate_converges()
+{
+  float rate = 1.0f;
+  for (int i = 0; i < 30; ++i)
+  {
+    rate = updateSleepRate(rate, 0.997f);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.997f, rate);
+}
+
+/* 睡眠期间复位或时间源错误造成的离群观测不影响估计 */
+static void test_rate_rejects_outliers()
+{
+  TEST_ASSERT_EQUAL_FLOAT(0.999f, updateSleepRate(0.999f, 0.5f));
+  TEST_ASSERT_EQUAL_FLOAT(0.999f, updateSleepRate(0.999f, 0.94f));
+  TEST_ASSERT_EQUAL_FLOAT(0.999f, updateSleepRate(0.999f, 1.06f));
+  TEST_ASSERT_EQUAL_FLOAT(0.999f, updateSleepRate(0.999f, 3.0f));
+}
+
+static void test_timer_seconds()
+{
+  // 含 2 秒余量，向上取整，宁可略晚唤醒
+  TEST_ASSERT_EQUAL_UINT64(3602, sleepTimerFor(3600, 1.0f));
+  // RTC 偏快（实际秒数少于定时器秒数）时需要更多定时器秒数
+  TEST_ASSERT_EQUAL_UINT64(3606, sleepTimerFor(3600, 0.999f));
+  TEST_ASSERT_EQUAL_UINT64(3599, sleepTimerFor(3600, 1.001f));
+}
+
+/* 换算使用 NVS 中保存的速率，没有时使用默认值（偏快约 0.15%） */
+static void test_calibrate_uses_stored_rate()
+{
+  TEST_ASSERT_EQUAL_UINT64(3608, calibrateSleepDuration(3600));
+
+  Preferences prefs;
+  prefs.begin(NVS_NAMESPACE, false);
+  prefs.putFloat("slpRate", 1.0f);
+  prefs.end();
+  TEST_ASSERT_EQUAL_UINT64(3602, calibrateSleepDuration(3600));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_rate_single_step);
+  RUN_TEST(test_rate_converges);
+  RUN_TEST(test_rate_rejects_outliers);
+  RUN_TEST(test_timer_seconds);
+  RUN_TEST(test_calibrate_uses_stored_rate);
+  return UNITY_END();
+}
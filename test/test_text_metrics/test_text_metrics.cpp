@@ -0,0 +1,151 @@
+/* 文本尺寸测量与缓存的主机测试
+ *
+ * 使用测试中构造的字体：8 位 GFX 字体（U+0020..U+00FF，每字步进 6，'g' 有下伸），
+ * 以及只含"中"、"文"两字的中文字体（步进 13）。
+ * 运行：pio test -e native -f test_text_metrics
+ */
+#include <unity.h>
+
+#include "text_metrics.h"
+
+static const uint16_t FIRST = 0x20, LAST = 0xFF;
+static GFXglyph latinGlyphs[LAST - FIRST + 1];
+static uint8_t latinBitmap[1];
+static GFXfont latin = {latinBitmap, latinGlyphs, FIRST, LAST, 10};
+// 内容相同的另一个字体，不配对中文字体
+static GFXfont latinOnly = {latinBitmap, latinGlyphs, FIRST, LAST, 10};
+
+static const uint8_t cjkBitmap[2 * 24] = {};
+static const cjk_glyph_t cjkGlyphs[] = {
+  {0,  12, 12, 13, 0, -11},
+  {24, 12, 12, 13, 0, -11},
+};
+static const uint16_t cjkCodepoints[] = {0x4E2D, 0x6587}; // 中、文
+static const cjk_font_t cjk = {cjkBitmap, cjkGlyphs, cjkCodepoints, 2, 14};
+
+void setUp() {}
+void tearDown() {}
+
+static void initFonts()
+{
+  for (uint16_t cp = FIRST; cp <= LAST; ++cp)
+  {
+    GFXglyph &g = latinGlyphs[cp - FIRST];
+    g = {0, 5, 7, 6, 0, -7};
+    if (cp == ' ')
+    {
+      g.width = g.height = 0;
+    }
+    else if (cp == 'g')
+    { // 下伸 2 像素
+      g.yOffset = -5;
+    }
+  }
+}
+
+static void test_advance()
+{
+  TEST_ASSERT_EQUAL_UINT16(0, measureAdvance(&latin, "", 0));
+  TEST_ASSERT_EQUAL_UINT16(18, measureAdvance(&latin, "abc", 3));
+  TEST_ASSERT_EQUAL_UINT16(12, measureAdvance(&latin, "abc", 2));
+  TEST_ASSERT_EQUAL_UINT16(18, measureAdvance(&latin, "a c", 3));
+  TEST_ASSERT_EQUAL_UINT16(0, measureAdvance(NULL, "abc", 3));
+}
+
+/* 外接矩形与 Adafruit_GFX::getTextBounds() 的规则相同 */
+static void test_bounds()
+{
+  text_bounds_t b = measureText(&latin, "ab", 2);
+  TEST_ASSERT_EQUAL_INT16(0, b.x1);
+  TEST_ASSERT_EQUAL_INT16(-7, b.y1);
+  TEST_ASSERT_EQUAL_UINT16(11, b.w);
+  TEST_ASSERT_EQUAL_UINT16(7, b.h);
+
+  b = measureText(&latin, "ag", 2);
+  TEST_ASSERT_EQUAL_INT16(-7, b.y1);
+  TEST_ASSERT_EQUAL_UINT16(9, b.h);
+
+  // 空格没有位图，只影响位置
+  b = measureText(&latin, " a", 2);
+  TEST_ASSERT_EQUAL_INT16(6, b.x1);
+  TEST_ASSERT_EQUAL_UINT16(5, b.w);
+
+  b = measureText(&latin, "", 0);
+  TEST_ASSERT_EQUAL_UINT16(0, b.w);
+  TEST_ASSERT_EQUAL_UINT16(0, b.h);
+}
+
+/* UTF-8 与 Latin-1 书写的同一字符宽度相同 */
+static void test_latin1_fallback()
+{
+  TEST_ASSERT_EQUAL_UINT16(12, measureAdvance(&latin, "\260C", 2));
+  TEST_ASSERT_EQUAL_UINT16(12, measureAdvance(&latin, "\xC2\xB0" "C", 3));
+
+  const char *p = "\260C";
+  TEST_ASSERT_EQUAL_HEX32(0xB0, nextTextChar(p));
+  TEST_ASSERT_EQUAL_HEX32('C', nextTextChar(p));
+  p = "\xC2\xB0";
+  TEST_ASSERT_EQUAL_HEX32(0xB0, nextTextChar(p));
+  TEST_ASSERT_EQUAL_HEX32(0, nextTextChar(p));
+}
+
+/* GFX 字体中没有的字符从配对的中文字体中查找 */
+static void test_cjk_font()
+{
+  const char text[] = "a中文";
+  size_t len = sizeof(text) - 1;
+  text_bounds_t before = measureText(&latin, text, len);
+  TEST_ASSERT_EQUAL_UINT16(6, measureAdvance(&latin, text, len));
+
+  registerCjkFont(&latin, &cjk);
+  TEST_ASSERT_EQUAL_UINT16(32, measureAdvance(&latin, text, len));
+  TEST_ASSERT_EQUAL_UINT16(6, measureAdvance(&latinOnly, text, len));
+  // 配对后缓存被清空，不返回配对前的结果
+  text_bounds_t b = measureText(&latin, text, len);
+  TEST_ASSERT_EQUAL_UINT16(5, before.w);
+  TEST_ASSERT_EQUAL_INT16(0, b.x1);
+  TEST_ASSERT_EQUAL_INT16(-11, b.y1);
+  TEST_ASSERT_EQUAL_UINT16(6 + 13 + 12, b.w);
+  TEST_ASSERT_EQUAL_UINT16(12, b.h);
+
+  glyph_info_t g;
+  TEST_ASSERT_TRUE(lookupGlyph(&latin, 0x6587, g));
+  TEST_ASSERT_TRUE(g.bitmap == cjkBitmap + 24);
+  TEST_ASSERT_FALSE(lookupGlyph(&latin, 0x5B57, g)); // 字体中没有"字"
+  TEST_ASSERT_FALSE(lookupGlyph(&latinOnly, 0x4E2D, g));
+
+  TEST_ASSERT_NULL(findCjkGlyph(&cjk, 0x4E2C));
+  TEST_ASSERT_NULL(findCjkGlyph(&cjk, 0x1F327));
+  TEST_ASSERT_NULL(findCjkGlyph(NULL, 0x4E2D));
+}
+
+/* 重复测量命中缓存；前缀、长度或字体不同时不会误用缓存的结果 */
+static void test_cache()
+{
+  uint32_t hits0, misses0, hits, misses;
+  getTextMetricsStats(hits0, misses0);
+  text_bounds_t a = measureText(&latin, "cached", 6);
+  text_bounds_t b = measureText(&latin, "cached", 6);
+  getTextMetricsStats(hits, misses);
+  TEST_ASSERT_EQUAL_UINT32(1, hits - hits0);
+  TEST_ASSERT_EQUAL_UINT32(1, misses - misses0);
+  TEST_ASSERT_EQUAL_MEMORY(&a, &b, sizeof(a));
+
+  TEST_ASSERT_EQUAL_UINT16(29, measureText(&latin, "cached", 5).w);
+  TEST_ASSERT_EQUAL_UINT16(35, measureText(&latinOnly, "cached", 6).w);
+  getTextMetricsStats(hits, misses);
+  TEST_ASSERT_EQUAL_UINT32(1, hits - hits0);
+  TEST_ASSERT_EQUAL_UINT32(3, misses - misses0);
+}
+
+int main(int argc, char **argv)
+{
+  initFonts();
+  UNITY_BEGIN();
+  RUN_TEST(test_advance);
+  RUN_TEST(test_bounds);
+  RUN_TEST(test_latin1_fallback);
+  RUN_TEST(test_cjk_font);
+  RUN_TEST(test_cache);
+  return UNITY_END();
+}